@@ -0,0 +1,71 @@
+﻿#pragma once
+
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "compiled_dfa.hpp"
+#include "nfa_simulation.hpp"
+#include "work_stealing_pool.hpp"
+
+// 批量匹配：用同一个自动机匹配大量（通常较短的）输入
+// 输入按BlockSize个一组作为线程池中的任务，结果先写入按组划分的64位字中（不同的任务不会写同一个字），最后再转换为vector<bool>
+// CompiledDFA与NFASimulator构造之后都是只读的，匹配只调用const成员函数，因此可以不加锁地在多个线程中共享；
+// NFA模拟所需的状态集合由每个工作线程各自的StreamMatcher提供，每个线程只分配一次
+namespace batch_match {
+
+// 每个任务处理的输入个数，必须是64的倍数
+constexpr size_t BlockSize = 1024;
+
+template<typename MatchFunction>
+static std::vector<bool> runBatch(size_t inputCount, WorkStealingPool& pool, const MatchFunction& match)
+{
+    std::vector<uint64_t> bits((inputCount + 63) / 64, 0);
+    const auto taskCount = (inputCount + BlockSize - 1) / BlockSize;
+    pool.parallelFor(taskCount, [&](size_t worker, size_t task) {
+        const auto begin = task * BlockSize;
+        const auto end = std::min(begin + BlockSize, inputCount);
+        for (auto index = begin; index < end; index++)
+        {
+            if (match(worker, index))
+            {
+                bits[index / 64] |= uint64_t(1) << (index % 64);
+            }
+        }
+    });
+
+    std::vector<bool> result(inputCount);
+    for (size_t index = 0; index < inputCount; index++)
+    {
+        result[index] = (bits[index / 64] >> (index % 64)) & 1;
+    }
+    return result;
+}
+
+// 返回每个输入是否被DFA接受
+static std::vector<bool> matchBatch(const CompiledDFA& dfa, std::span<const std::string_view> inputs, WorkStealingPool& pool)
+{
+    return runBatch(inputs.size(), pool, [&dfa, inputs](size_t, size_t index) {
+        return dfa.accept(inputs[index]);
+    });
+}
+
+// 返回每个输入是否被NFA接受
+static std::vector<bool> matchBatch(const NFASimulator& simulator, std::span<const std::string_view> inputs, WorkStealingPool& pool)
+{
+    // 每个工作线程的匹配器只由该线程在第一次使用时构造
+    std::vector<std::optional<NFASimulator::StreamMatcher>> matchers(pool.getWorkerCount());
+    return runBatch(inputs.size(), pool, [&simulator, &matchers, inputs](size_t worker, size_t index) {
+        auto& matcher = matchers[worker];
+        if (!matcher)
+        {
+            matcher.emplace(simulator);
+        }
+        matcher->reset();
+        matcher->feed(inputs[index]);
+        return matcher->finish();
+    });
+}
+
+}// namespace batch_match
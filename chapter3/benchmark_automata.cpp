@@ -0,0 +1,347 @@
+﻿// 构造与匹配的性能基准
+// 对几类典型的正则表达式分别测量：构造NFA、子集构造、最小化的耗时与状态数，以及各种匹配方式在不同输入大小下的吞吐量
+// 每条测量结果输出为一行JSON（JSON Lines），便于在不同版本之间比较性能回归
+// 内存使用通过替换全局的operator new/delete统计：每项测量报告执行一次该操作期间堆内存的峰值比执行之前增加了多少
+//
+// 用法：benchmark_automata [--max-input-size 字节数] [--max-exponent n] [--family 名称]
+//   --max-input-size  最大输入大小，默认64MB，输入大小从1B开始依次增大直到此值（例如1073741824即1GB）
+//   --max-exponent    (a|b)*a(a|b){n} 中n的最大值，默认14，DFA的状态数为2^(n+1)
+//   --family          只运行名称中包含此字符串的模式族
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "compiled_dfa.hpp"
+#include "lazy_dfa.hpp"
+#include "nfa2dfa.hpp"
+#include "nfa_alternation.hpp"
+#include "nfa_concatenate.hpp"
+#include "nfa_repeat.hpp"
+#include "nfa_simulation.hpp"
+#include "regex_generate.hpp"
+
+namespace {
+
+// 正在使用的堆内存字节数，以及自上次重置以来的峰值（基准是单线程的）
+size_t heapBytesInUse = 0;
+size_t heapBytesPeak = 0;
+// 每块内存前面记录其大小，保持operator new返回的地址的对齐
+constexpr size_t HeapHeaderSize = alignof(std::max_align_t);
+
+}// namespace
+
+// 数组形式与nothrow形式的默认实现都会调用这两个函数
+void* operator new(size_t size)
+{
+    auto* block = static_cast<char*>(std::malloc(size + HeapHeaderSize));
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t*>(block) = size;
+    heapBytesInUse += size;
+    heapBytesPeak = std::max(heapBytesPeak, heapBytesInUse);
+    return block + HeapHeaderSize;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+    auto* block = static_cast<char*>(pointer) - HeapHeaderSize;
+    heapBytesInUse -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+namespace {
+
+// 每项测量至少持续的时间，输入较小时重复执行多次后取平均
+constexpr double MinMeasureSeconds = 0.1;
+// NFA::accept 与 DFA::accept 较慢，输入超过此大小时跳过
+constexpr size_t MaxSlowInputSize = 64 * 1024 * 1024;
+
+struct Options
+{
+    size_t maxInputSize = 64 * 1024 * 1024;
+    int maxExponent = 14;
+    std::string family;
+};
+
+// 模式族：正则表达式（或直接用组合子构造的NFA），以及生成不会使自动机提前失败的输入的方法
+struct Workload
+{
+    std::string family;
+    std::string pattern;
+    std::function<NFA()> buildByOperator;
+    // 输入由这些片段随机拼接而成
+    std::vector<std::string> pieces;
+};
+
+std::string escapeJson(std::string_view text)
+{
+    std::string escaped;
+    for (const auto c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+struct Record
+{
+    std::string_view family{};
+    std::string_view pattern{};
+    std::string_view operation{};
+    size_t inputSize = 0;
+    double seconds = 0;
+    size_t iterations = 1;
+    size_t states = 0;
+    // 执行一次该操作期间堆内存的峰值比执行之前增加的字节数
+    size_t operationPeakHeapBytes = 0;
+};
+
+void report(const Record& record)
+{
+    const auto throughput = record.inputSize > 0 && record.seconds > 0 ? record.inputSize / record.seconds / (1024 * 1024) : 0.0;
+    std::cout << std::format(R"({{"family":"{}","pattern":"{}","operation":"{}","input_size":{},"iterations":{},"seconds":{:.9f},"mb_per_s":{:.3f},"states":{},"operation_peak_heap_bytes":{}}})",
+                             escapeJson(record.family),
+                             escapeJson(record.pattern),
+                             record.operation,
+                             record.inputSize,
+                             record.iterations,
+                             record.seconds,
+                             throughput,
+                             record.states,
+                             record.operationPeakHeapBytes)
+              << std::endl;
+}
+
+// 反复执行直到累计时间超过MinMeasureSeconds，返回[平均每次的秒数、次数、第一次执行期间堆内存峰值的增量]
+// 结果写入volatile变量，防止被优化掉
+template<typename Function>
+std::tuple<double, size_t, size_t> measure(Function&& function)
+{
+    volatile size_t sink = 0;
+    size_t iterations = 0;
+    size_t peakHeapBytes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do
+    {
+        const auto heapBytesBefore = heapBytesInUse;
+        heapBytesPeak = heapBytesInUse;
+        sink = sink + static_cast<size_t>(function());
+        if (iterations == 0)
+        {
+            peakHeapBytes = heapBytesPeak - heapBytesBefore;
+        }
+        iterations++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < MinMeasureSeconds);
+    return {elapsed / iterations, iterations, peakHeapBytes};
+}
+
+std::vector<Workload> makeWorkloads(const Options& options)
+{
+    std::vector<Workload> workloads;
+    workloads.push_back({"literal", "(the quick brown fox )*", nullptr, {"the quick brown fox "}});
+    workloads.push_back({"wide_range", "[ -~]*", nullptr, {}});
+    for (char c = ' '; c <= '~'; c++)
+    {
+        workloads.back().pieces.push_back(std::string(1, c));
+    }
+    workloads.push_back({"nested", "((a|bc)*(d|ef)+)*", nullptr, {"a", "bc", "d", "ef"}});
+
+    // (a|b)*a(a|b){n}：NFA有O(n)个状态，DFA有2^(n+1)个状态
+    for (int n = 4; n <= options.maxExponent; n += 2)
+    {
+        workloads.push_back({"exponential",
+                             std::format("(a|b)*a(a|b){{{}}}", n),
+                             [n] {
+                                 const auto either = nfa_operator::alternation(regex_generate::Symbol('a'), regex_generate::Symbol('b'));
+                                 auto nfa = nfa_operator::concatenate(nfa_operator::repeat(either), regex_generate::Symbol('a'));
+                                 for (int i = 0; i < n; i++)
+                                 {
+                                     nfa = nfa_operator::concatenate(nfa, either);
+                                 }
+                                 return nfa;
+                             },
+                             {"a", "b"}});
+    }
+    return workloads;
+}
+
+std::vector<size_t> getInputSizes(size_t maxInputSize)
+{
+    std::vector<size_t> sizes;
+    for (const size_t size : {size_t(1), size_t(1) << 10, size_t(64) << 10, size_t(1) << 20, size_t(16) << 20, size_t(256) << 20, size_t(1) << 30})
+    {
+        if (size <= maxInputSize)
+        {
+            sizes.push_back(size);
+        }
+    }
+    return sizes;
+}
+
+std::vector<InputType> makeInput(const Workload& workload, size_t size, std::mt19937& engine)
+{
+    std::vector<InputType> input;
+    input.reserve(size + 64);
+    while (input.size() < size)
+    {
+        const auto& piece = workload.pieces[engine() % workload.pieces.size()];
+        input.insert(input.end(), piece.begin(), piece.end());
+    }
+    input.resize(size);
+    return input;
+}
+
+void runWorkload(const Workload& workload, const Options& options)
+{
+    Record record{workload.family, workload.pattern};
+
+    // 构造
+    std::optional<NFA> nfa;
+    std::tie(record.seconds, record.iterations, record.operationPeakHeapBytes) = measure([&] {
+        nfa.emplace(regex_generate::compile(workload.pattern));
+        return nfa->getStateCount();
+    });
+    record.operation = "regex_generate::compile";
+    record.states = nfa->getStateCount();
+    report(record);
+
+    if (workload.buildByOperator)
+    {
+        std::optional<NFA> operatorNFA;
+        std::tie(record.seconds, record.iterations, record.operationPeakHeapBytes) = measure([&] {
+            operatorNFA.emplace(workload.buildByOperator());
+            return operatorNFA->getStateCount();
+        });
+        record.operation = "nfa_operator";
+        record.states = operatorNFA->getStateCount();
+        report(record);
+    }
+
+    std::optional<DFA> dfa;
+    std::tie(record.seconds, record.iterations, record.operationPeakHeapBytes) = measure([&] {
+        dfa.emplace(nfa2dfa::convertNFA2DFA(*nfa));
+        return dfa->getStateCount();
+    });
+    record.operation = "nfa2dfa::convertNFA2DFA";
+    record.states = dfa->getStateCount();
+    report(record);
+
+    std::optional<DFA> minimized;
+    std::tie(record.seconds, record.iterations, record.operationPeakHeapBytes) = measure([&] {
+        minimized.emplace(dfa->minimize());
+        return minimized->getStateCount();
+    });
+    record.operation = "DFA::minimize";
+    record.states = minimized->getStateCount();
+    report(record);
+
+    const NFASimulator simulator(*nfa);
+    const CompiledDFA compiled(*minimized);
+    LazyDFA lazy(*nfa);
+
+    // 匹配
+    std::mt19937 engine(1);
+    for (const auto size : getInputSizes(options.maxInputSize))
+    {
+        const auto input = makeInput(workload, size, engine);
+        const std::string_view view(input.data(), input.size());
+        record.inputSize = size;
+
+        const auto run = [&](std::string_view operation, size_t states, auto&& function) {
+            std::tie(record.seconds, record.iterations, record.operationPeakHeapBytes) = measure(function);
+            record.operation = operation;
+            record.states = states;
+            report(record);
+        };
+
+        if (size <= MaxSlowInputSize)
+        {
+            run("NFA::accept", nfa->getStateCount(), [&] { return nfa->accept(input); });
+            run("DFA::accept", minimized->getStateCount(), [&] { return minimized->accept(input); });
+        }
+        run("NFASimulator::accept", nfa->getStateCount(), [&] { return simulator.accept(view); });
+        run("LazyDFA::accept", nfa->getStateCount(), [&] { return lazy.accept(view); });
+        run("CompiledDFA::accept", compiled.getStateCount(), [&] { return compiled.accept(view); });
+    }
+}
+
+std::optional<Options> parseOptions(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view name = argv[i];
+        if (i + 1 >= argc)
+        {
+            return std::nullopt;
+        }
+        const std::string value = argv[++i];
+        if (name == "--max-input-size")
+        {
+            options.maxInputSize = std::stoull(value);
+        }
+        else if (name == "--max-exponent")
+        {
+            options.maxExponent = std::stoi(value);
+        }
+        else if (name == "--family")
+        {
+            options.family = value;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+}// namespace
+
+int main(int argc, char** argv)
+{
+    const auto options = parseOptions(argc, argv);
+    if (!options)
+    {
+        std::cerr << "usage: benchmark_automata [--max-input-size bytes] [--max-exponent n] [--family name]" << std::endl;
+        return 1;
+    }
+
+    for (const auto& workload : makeWorkloads(*options))
+    {
+        if (workload.family.find(options->family) != std::string::npos)
+        {
+            runWorkload(workload, *options);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,284 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "fa_common.hpp"
+
+// 字节类编号
+using ByteClassId = std::uint8_t;
+// 字节集合，第i位表示字节i是否属于集合
+using ByteSet = std::bitset<256>;
+
+// 字节区间集合，作为NFA状态转移的标签，一条转移可以接受单个字节，也可以接受一个或多个字节区间（字符类）
+// 内部使用256位的位集合保存，因此判断是否包含某字节为O(1)，且不需要分配内存
+class ByteRangeSet
+{
+public:
+    ByteRangeSet() = default;
+
+    // 单个字节
+    ByteRangeSet(InputType input)
+    {
+        _bytes.set(static_cast<unsigned char>(input));
+    }
+
+    // 字节区间 [first, last]
+    ByteRangeSet(InputType first, InputType last)
+    {
+        for (auto byte = static_cast<size_t>(static_cast<unsigned char>(first)); byte <= static_cast<unsigned char>(last); byte++)
+        {
+            _bytes.set(byte);
+        }
+    }
+
+    explicit ByteRangeSet(const ByteSet& bytes)
+        : _bytes(bytes)
+    {
+    }
+
+    bool contains(InputType input) const
+    {
+        return _bytes.test(static_cast<unsigned char>(input));
+    }
+
+    const ByteSet& getBytes() const
+    {
+        return _bytes;
+    }
+
+    bool empty() const
+    {
+        return _bytes.none();
+    }
+
+    // 获取有序且互不相交的字节区间列表
+    std::vector<std::pair<unsigned char, unsigned char>> getRanges() const
+    {
+        std::vector<std::pair<unsigned char, unsigned char>> ranges;
+        for (size_t byte = 0; byte < 256;)
+        {
+            if (!_bytes.test(byte))
+            {
+                byte++;
+                continue;
+            }
+            auto last = byte;
+            while (last + 1 < 256 && _bytes.test(last + 1))
+            {
+                last++;
+            }
+            ranges.push_back({static_cast<unsigned char>(byte), static_cast<unsigned char>(last)});
+            byte = last + 1;
+        }
+        return ranges;
+    }
+
+    // 生成展示文本，单个字节直接输出，否则以区间的形式输出，比如 [a-z]
+    std::string toString() const
+    {
+        if (_bytes.count() == 1)
+        {
+            return std::string{static_cast<char>(getRanges().front().first)};
+        }
+
+        std::string str = "[";
+        for (const auto& [first, last] : getRanges())
+        {
+            str += static_cast<char>(first);
+            if (last > first)
+            {
+                str += '-';
+                str += static_cast<char>(last);
+            }
+        }
+        str += "]";
+        return str;
+    }
+
+    bool operator==(const ByteRangeSet& right) const
+    {
+        return _bytes == right._bytes;
+    }
+
+private:
+    ByteSet _bytes;
+};
+
+// 字节等价类
+// 若所有的状态转移对两个字节的处理方式都相同（要么同时接受，要么同时不接受），那么这两个字节属于同一个字节类
+// 状态机只需在字节类上（而不是在256个字节上）进行子集构造、最小化以及构造状态转移表，
+// 匹配时通过256项的映射表把输入字节转换为字节类即可
+class ByteClasses
+{
+public:
+    // 默认所有字节属于同一个字节类
+    ByteClasses()
+        : _classCount(1)
+    {
+        _classMap.fill(0);
+    }
+
+    // 根据字节到字节类的映射表构造，字节类会按照其包含的最小字节重新编号，保证相同的划分得到相同的编号
+    explicit ByteClasses(const std::array<ByteClassId, 256>& classMap)
+    {
+        std::array<int, 256> renumber;
+        renumber.fill(-1);
+        int classCount = 0;
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            auto& newClass = renumber[classMap[byte]];
+            if (newClass < 0)
+            {
+                newClass = classCount++;
+            }
+            _classMap[byte] = static_cast<ByteClassId>(newClass);
+        }
+        _classCount = classCount;
+    }
+
+    ByteClassId getClass(InputType input) const
+    {
+        return _classMap[static_cast<unsigned char>(input)];
+    }
+
+    size_t getClassCount() const
+    {
+        return _classCount;
+    }
+
+    const std::array<ByteClassId, 256>& getClassMap() const
+    {
+        return _classMap;
+    }
+
+    // 获取字节类中的代表字节（即最小的字节）
+    InputType getRepresentative(ByteClassId byteClass) const
+    {
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            if (_classMap[byte] == byteClass)
+            {
+                return static_cast<InputType>(byte);
+            }
+        }
+        return 0;
+    }
+
+    ByteSet getBytes(ByteClassId byteClass) const
+    {
+        ByteSet bytes;
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            if (_classMap[byte] == byteClass)
+            {
+                bytes.set(byte);
+            }
+        }
+        return bytes;
+    }
+
+    // 合并字节类，mergeTo[c]表示字节类c合并之后所属的字节类
+    ByteClasses merge(const std::vector<ByteClassId>& mergeTo) const
+    {
+        std::array<ByteClassId, 256> classMap;
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            classMap[byte] = mergeTo[_classMap[byte]];
+        }
+        return ByteClasses(classMap);
+    }
+
+    // 获取被某字节集合完整覆盖的字节类（有序），字节集合必须是若干字节类的并集，比如构造本字节类时使用过的字节集合
+    std::vector<ByteClassId> getClasses(const ByteSet& bytes) const
+    {
+        std::vector<bool> covered(_classCount, false);
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            if (bytes.test(byte))
+            {
+                covered[_classMap[byte]] = true;
+            }
+        }
+        std::vector<ByteClassId> classes;
+        for (size_t byteClass = 0; byteClass < _classCount; byteClass++)
+        {
+            if (covered[byteClass])
+            {
+                classes.push_back(static_cast<ByteClassId>(byteClass));
+            }
+        }
+        return classes;
+    }
+
+    // 生成字节类的展示文本，单个字节直接输出，否则以区间的形式输出，比如 [a-z]
+    std::string toString(ByteClassId byteClass) const
+    {
+        return ByteRangeSet(getBytes(byteClass)).toString();
+    }
+
+private:
+    std::array<ByteClassId, 256> _classMap;
+    size_t _classCount;
+};
+
+// 字节类构造器
+// 每添加一个字节集合（即某个状态转移所接受的字节），就用它对已有的字节类进行一次划分
+class ByteClassBuilder
+{
+public:
+    void add(InputType input)
+    {
+        ByteSet bytes;
+        bytes.set(static_cast<unsigned char>(input));
+        add(bytes);
+    }
+
+    void add(const ByteSet& bytes)
+    {
+        _byteSets.push_back(bytes);
+    }
+
+    ByteClasses build() const
+    {
+        std::array<ByteClassId, 256> classMap;
+        classMap.fill(0);
+        size_t classCount = 1;
+
+        // 对字节集合去重，相同的字节集合不会带来新的划分
+        // 划分的结果与划分的顺序无关，因此可以使用无序集合
+        const std::unordered_set<ByteSet> byteSets(_byteSets.begin(), _byteSets.end());
+
+        for (const auto& bytes : byteSets)
+        {
+            // 每个已有的字节类被划分为 [属于bytes的部分、不属于bytes的部分]
+            std::array<int, 512> splitClass;
+            splitClass.fill(-1);
+            size_t newClassCount = 0;
+            for (size_t byte = 0; byte < 256; byte++)
+            {
+                auto& newClass = splitClass[classMap[byte] * 2 + (bytes.test(byte) ? 1 : 0)];
+                if (newClass < 0)
+                {
+                    newClass = static_cast<int>(newClassCount++);
+                }
+                classMap[byte] = static_cast<ByteClassId>(newClass);
+            }
+            classCount = newClassCount;
+            if (classCount == 256)
+            {
+                break;
+            }
+        }
+
+        return ByteClasses(classMap);
+    }
+
+private:
+    std::vector<ByteSet> _byteSets;
+};
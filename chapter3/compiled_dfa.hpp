@@ -0,0 +1,532 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dfa.hpp"
+#include "fa_statistics.hpp"
+
+// 编译后的DFA
+// 将DFA的状态转移表展开为一块连续的 [状态 x 字节类] 数组，匹配时先通过256项的映射表把字节转换为字节类，
+// 再通过一次下标访问得到下一个状态
+// 状态0为死状态（任意输入都转移回自身，且不可接受），DFA中编号为i的状态对应编译后的状态i+1
+// DFA中无法到达终止状态的状态都合并到死状态；全部接受汇点合并为其中一个（任意输入都转移回自身，且可接受），
+// 匹配时进入死状态或接受汇点之后结果已经确定，剩余的输入不再处理
+// 为了减少匹配循环中的乘法，数组中保存的下一个状态是预先乘以行宽之后的行偏移
+// 需要分块提供输入时使用StreamMatcher
+//
+// 编译后的DFA可以序列化为与地址无关的二进制格式（serialize），并直接在这块内存上加载（load），加载时不复制状态转移表，
+// 因此可以把文件mmap之后加载，多个进程共享同一份页缓存。格式（小端序，各段按64字节对齐，偏移量相对于数据的开头）：
+// [文件头 CompiledDFAFileHeader][字节类映射 256字节][状态转移表 uint32 x 状态数 x 行宽][可接受位图 uint64 x ⌈状态数/64⌉]
+// [可选：状态名称的偏移 uint32 x (状态数 + 1)][可选：状态名称的字符]
+
+// 序列化数据的文件头
+struct CompiledDFAFileHeader
+{
+    static constexpr char Magic[8] = {'F', 'A', 'C', 'D', 'F', 'A', '\r', '\n'};
+    static constexpr uint32_t CurrentVersion = 2;
+    static constexpr uint32_t EndianTag = 0x01020304;
+
+    char magic[8];
+    uint32_t version;
+    // 用于检查读写双方的字节序是否一致
+    uint32_t endianTag;
+    uint64_t stateCount;
+    uint64_t rowWidth;
+    uint64_t initialState;
+    // 接受汇点（的行偏移），没有接受汇点时为0
+    uint64_t acceptSinkState;
+    uint64_t classMapOffset;
+    uint64_t tableOffset;
+    uint64_t acceptOffset;
+    // 没有状态名称时为0
+    uint64_t nameOffsetsOffset;
+    uint64_t nameCharsOffset;
+    uint64_t nameCharsSize;
+    uint64_t totalSize;
+};
+
+// 序列化数据无效
+class CompiledDFAFormatError : public std::runtime_error
+{
+public:
+    explicit CompiledDFAFormatError(const std::string& message)
+        : std::runtime_error(message)
+    {
+    }
+};
+
+class CompiledDFA
+{
+public:
+    // 死状态（的行偏移）
+    static constexpr uint32_t DeadState = 0;
+    // 匹配时每处理这么多字节检查一次是否已经进入死状态或接受汇点，检查不会拖慢逐字节的查表循环
+    static constexpr size_t EarlyExitCheckInterval = 64;
+
+    // mergeAcceptSinks为false时每个DFA状态都保留自己的行，不合并接受汇点（也就不会在接受汇点提前结束匹配），
+    // 用于需要按状态区分终止状态的调用者（比如词法分析器按状态标记记号）
+    explicit CompiledDFA(const DFA& dfa, bool mergeAcceptSinks = true)
+        : _stateCount(dfa.getStateCount() + 1),
+          _rowWidth(dfa.getByteClasses().getClassCount()),
+          _classMap(dfa.getByteClasses().getClassMap()),
+          _ownedTable(_stateCount * _rowWidth, DeadState),
+          _ownedAcceptStateBits((_stateCount + 63) / 64, 0)
+    {
+        const auto live = dfa.getLiveStates();
+        for (StateId state = 0; state < dfa.getStateCount() && mergeAcceptSinks; state++)
+        {
+            if (dfa.isAcceptSink(state))
+            {
+                _acceptSinkState = toRowOffset(state);
+                break;
+            }
+        }
+        // 无法到达终止状态的状态映射为死状态，接受汇点映射为合并后的接受汇点
+        const auto getRowOffset = [&](StateId state) {
+            if (!live[state])
+            {
+                return DeadState;
+            }
+            return mergeAcceptSinks && dfa.isAcceptSink(state) ? _acceptSinkState : toRowOffset(state);
+        };
+
+        _initialState = getRowOffset(dfa.getInitialState());
+        for (const auto& transition : dfa.getTransitions())
+        {
+            _ownedTable[toRowOffset(transition.startState) + transition.input] = getRowOffset(transition.nextState);
+        }
+
+        for (const auto state : dfa.getAcceptStateList())
+        {
+            const auto index = state + 1;
+            _ownedAcceptStateBits[index / 64] |= uint64_t(1) << (index % 64);
+        }
+
+        // 状态名称：编译后的状态i+1对应DFA的状态i，死状态没有名称
+        if (!dfa.getStateNames().empty())
+        {
+            _ownedNameOffsets.push_back(0);
+            _ownedNameOffsets.push_back(0);
+            for (StateId state = 0; state < dfa.getStateCount(); state++)
+            {
+                _ownedNameChars += dfa.getStateName(state);
+                _ownedNameOffsets.push_back(static_cast<uint32_t>(_ownedNameChars.size()));
+            }
+        }
+
+        bindOwnedStorage();
+    }
+
+    CompiledDFA(const CompiledDFA& other)
+    {
+        *this = other;
+    }
+
+    CompiledDFA& operator=(const CompiledDFA& other)
+    {
+        if (this != &other)
+        {
+            _stateCount = other._stateCount;
+            _rowWidth = other._rowWidth;
+            _classMap = other._classMap;
+            _initialState = other._initialState;
+            _acceptSinkState = other._acceptSinkState;
+            _ownedTable = other._ownedTable;
+            _ownedAcceptStateBits = other._ownedAcceptStateBits;
+            _ownedNameOffsets = other._ownedNameOffsets;
+            _ownedNameChars = other._ownedNameChars;
+            _table = other._table;
+            _acceptStateBits = other._acceptStateBits;
+            _nameOffsets = other._nameOffsets;
+            _nameChars = other._nameChars;
+            if (other.isOwner())
+            {
+                bindOwnedStorage();
+            }
+        }
+        return *this;
+    }
+
+    CompiledDFA(CompiledDFA&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    CompiledDFA& operator=(CompiledDFA&& other) noexcept
+    {
+        if (this != &other)
+        {
+            _stateCount = other._stateCount;
+            _rowWidth = other._rowWidth;
+            _classMap = other._classMap;
+            _initialState = other._initialState;
+            _acceptSinkState = other._acceptSinkState;
+            _ownedTable = std::move(other._ownedTable);
+            _ownedAcceptStateBits = std::move(other._ownedAcceptStateBits);
+            _ownedNameOffsets = std::move(other._ownedNameOffsets);
+            _ownedNameChars = std::move(other._ownedNameChars);
+            _table = other._table;
+            _acceptStateBits = other._acceptStateBits;
+            _nameOffsets = other._nameOffsets;
+            _nameChars = other._nameChars;
+            // 短字符串移动之后地址会改变，因此拥有存储时总是重新绑定
+            if (isOwner())
+            {
+                bindOwnedStorage();
+            }
+        }
+        return *this;
+    }
+
+    // 在序列化的数据上加载，不复制状态转移表；返回的对象引用data，使用期间data必须有效且不被修改
+    // data的起始地址至少需要8字节对齐（mmap得到的地址总是满足）
+    // verifyTransitions为true时检查状态转移表中的每一项，对于可信的数据可以传入false，此时加载的耗时与DFA的大小无关
+    static CompiledDFA load(std::span<const std::byte> data, bool verifyTransitions = true)
+    {
+        if (data.size() < sizeof(CompiledDFAFileHeader))
+        {
+            throw CompiledDFAFormatError("data is too small");
+        }
+        if (reinterpret_cast<uintptr_t>(data.data()) % alignof(uint64_t) != 0)
+        {
+            throw CompiledDFAFormatError("data is not aligned");
+        }
+
+        CompiledDFAFileHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, CompiledDFAFileHeader::Magic, sizeof(header.magic)) != 0)
+        {
+            throw CompiledDFAFormatError("bad magic");
+        }
+        if (header.endianTag != CompiledDFAFileHeader::EndianTag)
+        {
+            throw CompiledDFAFormatError("byte order mismatch");
+        }
+        if (header.version != CompiledDFAFileHeader::CurrentVersion)
+        {
+            throw CompiledDFAFormatError("unsupported version " + std::to_string(header.version));
+        }
+        if (header.totalSize > data.size())
+        {
+            throw CompiledDFAFormatError("data is truncated");
+        }
+        if (header.stateCount == 0 || header.stateCount > UINT32_MAX || header.rowWidth == 0 || header.rowWidth > 256 ||
+            header.stateCount * header.rowWidth > UINT32_MAX)
+        {
+            throw CompiledDFAFormatError("bad state count or row width");
+        }
+
+        // 检查每一段都位于数据之内并且满足对齐要求
+        const auto checkSection = [&header](uint64_t offset, uint64_t size, size_t alignment) {
+            if (offset % alignment != 0 || offset > header.totalSize || size > header.totalSize - offset)
+            {
+                throw CompiledDFAFormatError("bad section");
+            }
+        };
+        const auto tableSize = header.stateCount * header.rowWidth;
+        const auto acceptWords = (header.stateCount + 63) / 64;
+        checkSection(header.classMapOffset, 256, 1);
+        checkSection(header.tableOffset, tableSize * sizeof(uint32_t), alignof(uint32_t));
+        checkSection(header.acceptOffset, acceptWords * sizeof(uint64_t), alignof(uint64_t));
+        if (header.nameOffsetsOffset != 0)
+        {
+            checkSection(header.nameOffsetsOffset, (header.stateCount + 1) * sizeof(uint32_t), alignof(uint32_t));
+            checkSection(header.nameCharsOffset, header.nameCharsSize, 1);
+        }
+
+        CompiledDFA dfa;
+        dfa._stateCount = header.stateCount;
+        dfa._rowWidth = header.rowWidth;
+        dfa._initialState = static_cast<uint32_t>(header.initialState);
+        dfa._acceptSinkState = static_cast<uint32_t>(header.acceptSinkState);
+        std::memcpy(dfa._classMap.data(), data.data() + header.classMapOffset, 256);
+        dfa._table = reinterpret_cast<const uint32_t*>(data.data() + header.tableOffset);
+        dfa._acceptStateBits = reinterpret_cast<const uint64_t*>(data.data() + header.acceptOffset);
+        if (header.nameOffsetsOffset != 0)
+        {
+            dfa._nameOffsets = reinterpret_cast<const uint32_t*>(data.data() + header.nameOffsetsOffset);
+            dfa._nameChars = std::string_view(reinterpret_cast<const char*>(data.data() + header.nameCharsOffset), header.nameCharsSize);
+            for (size_t state = 0; state < dfa._stateCount; state++)
+            {
+                if (dfa._nameOffsets[state] > dfa._nameOffsets[state + 1] || dfa._nameOffsets[state + 1] > dfa._nameChars.size())
+                {
+                    throw CompiledDFAFormatError("bad state name offsets");
+                }
+            }
+        }
+
+        if (header.initialState % header.rowWidth != 0 || header.initialState >= tableSize)
+        {
+            throw CompiledDFAFormatError("bad initial state");
+        }
+        // 接受汇点必须可接受且任意输入都转移回自身，否则提前结束匹配会得到错误的结果
+        if (header.acceptSinkState != DeadState)
+        {
+            if (header.acceptSinkState % header.rowWidth != 0 || header.acceptSinkState >= tableSize)
+            {
+                throw CompiledDFAFormatError("bad accept sink state");
+            }
+            const auto* row = dfa._table + header.acceptSinkState;
+            if (!dfa.isAcceptState(dfa._acceptSinkState) ||
+                !std::all_of(row, row + header.rowWidth, [&header](uint32_t next) { return next == header.acceptSinkState; }))
+            {
+                throw CompiledDFAFormatError("bad accept sink state");
+            }
+        }
+        for (const auto byteClass : dfa._classMap)
+        {
+            if (byteClass >= header.rowWidth)
+            {
+                throw CompiledDFAFormatError("bad byte class map");
+            }
+        }
+        if (verifyTransitions)
+        {
+            for (size_t i = 0; i < tableSize; i++)
+            {
+                if (dfa._table[i] % header.rowWidth != 0 || dfa._table[i] >= tableSize)
+                {
+                    throw CompiledDFAFormatError("bad transition");
+                }
+            }
+        }
+        return dfa;
+    }
+
+    // 序列化为二进制数据，格式见类的注释
+    std::vector<std::byte> serialize() const
+    {
+        const auto align = [](uint64_t offset) {
+            return (offset + 63) / 64 * 64;
+        };
+        const auto tableSize = _stateCount * _rowWidth;
+        const auto acceptWords = (_stateCount + 63) / 64;
+
+        CompiledDFAFileHeader header{};
+        std::memcpy(header.magic, CompiledDFAFileHeader::Magic, sizeof(header.magic));
+        header.version = CompiledDFAFileHeader::CurrentVersion;
+        header.endianTag = CompiledDFAFileHeader::EndianTag;
+        header.stateCount = _stateCount;
+        header.rowWidth = _rowWidth;
+        header.initialState = _initialState;
+        header.acceptSinkState = _acceptSinkState;
+        header.classMapOffset = align(sizeof(header));
+        header.tableOffset = align(header.classMapOffset + 256);
+        header.acceptOffset = align(header.tableOffset + tableSize * sizeof(uint32_t));
+        header.totalSize = header.acceptOffset + acceptWords * sizeof(uint64_t);
+        if (_nameOffsets)
+        {
+            header.nameOffsetsOffset = align(header.totalSize);
+            header.nameCharsOffset = header.nameOffsetsOffset + (_stateCount + 1) * sizeof(uint32_t);
+            header.nameCharsSize = _nameChars.size();
+            header.totalSize = header.nameCharsOffset + header.nameCharsSize;
+        }
+
+        std::vector<std::byte> data(header.totalSize);
+        std::memcpy(data.data(), &header, sizeof(header));
+        std::memcpy(data.data() + header.classMapOffset, _classMap.data(), 256);
+        std::memcpy(data.data() + header.tableOffset, _table, tableSize * sizeof(uint32_t));
+        std::memcpy(data.data() + header.acceptOffset, _acceptStateBits, acceptWords * sizeof(uint64_t));
+        if (_nameOffsets)
+        {
+            std::memcpy(data.data() + header.nameOffsetsOffset, _nameOffsets, (_stateCount + 1) * sizeof(uint32_t));
+            std::memcpy(data.data() + header.nameCharsOffset, _nameChars.data(), _nameChars.size());
+        }
+        return data;
+    }
+
+    // 此对象是否拥有自己的状态转移表（否则引用load时传入的数据）
+    bool isOwner() const
+    {
+        return !_ownedTable.empty();
+    }
+
+    // 状态个数（包括死状态）
+    size_t getStateCount() const
+    {
+        return _stateCount;
+    }
+
+    // 每一行的宽度，即字节类的个数
+    size_t getRowWidth() const
+    {
+        return _rowWidth;
+    }
+
+    uint32_t getInitialState() const
+    {
+        return _initialState;
+    }
+
+    // 接受汇点（的行偏移），没有接受汇点时返回DeadState
+    uint32_t getAcceptSinkState() const
+    {
+        return _acceptSinkState;
+    }
+
+    // 获取某状态在接受一个字节之后转移到的状态
+    uint32_t getNextState(uint32_t state, InputType input) const
+    {
+        return _table[state + _classMap[static_cast<unsigned char>(input)]];
+    }
+
+    bool isAcceptState(uint32_t state) const
+    {
+        const auto index = state / _rowWidth;
+        return (_acceptStateBits[index / 64] >> (index % 64)) & 1;
+    }
+
+    // 获取状态的名称，DFA没有状态名称时返回空
+    std::string_view getStateName(uint32_t state) const
+    {
+        if (!_nameOffsets)
+        {
+            return {};
+        }
+        const auto index = state / _rowWidth;
+        return _nameChars.substr(_nameOffsets[index], _nameOffsets[index + 1] - _nameOffsets[index]);
+    }
+
+    // 状态转移表占用的字节数
+    size_t getTableBytes() const
+    {
+        return _stateCount * _rowWidth * sizeof(uint32_t);
+    }
+
+    // 判断从初始状态开始，此FA是否接受输入序列
+    bool accept(std::string_view inputs) const
+    {
+        StreamMatcher matcher(*this);
+        matcher.feed(inputs);
+        return matcher.finish();
+    }
+
+    bool accept(const std::vector<InputType>& inputs) const
+    {
+        return accept(std::string_view(inputs.data(), inputs.size()));
+    }
+
+    // 流式匹配器：只保存当前状态，输入可以分成多块（比如来自网络或文件的数据块）依次提供
+    // feed既不复制输入也不分配内存，因此可以用常量内存匹配任意长的数据流
+    // 匹配器引用构造它的CompiledDFA，使用期间CompiledDFA必须有效
+    class StreamMatcher
+    {
+    public:
+        explicit StreamMatcher(const CompiledDFA& dfa)
+            : _dfa(dfa),
+              _currentState(dfa._initialState)
+        {
+        }
+
+        // 回到初始状态，开始匹配一个新的数据流
+        void reset()
+        {
+            _currentState = _dfa._initialState;
+        }
+
+        // 接受一块输入
+        // 按EarlyExitCheckInterval分段处理，进入死状态或接受汇点之后跳过剩余的输入（它们不会再改变当前状态）
+        void feed(std::span<const char> inputs)
+        {
+            const auto* table = _dfa._table;
+            const auto* classMap = _dfa._classMap.data();
+            auto currentState = _currentState;
+            size_t position = 0;
+            while (position < inputs.size() && !isDecided(currentState))
+            {
+                const auto blockEnd = std::min(inputs.size(), position + EarlyExitCheckInterval);
+                for (; position < blockEnd; position++)
+                {
+                    currentState = table[currentState + classMap[static_cast<unsigned char>(inputs[position])]];
+                }
+            }
+            _currentState = currentState;
+            FA_STATISTICS_ADD(bytesProcessed, position);
+            if (position < inputs.size() && currentState == DeadState)
+            {
+                FA_STATISTICS_ADD(deadStateExits, 1);
+            }
+        }
+
+        // 判断到目前为止提供的全部输入是否被接受；不改变匹配状态，之后仍然可以继续feed
+        bool finish() const
+        {
+            return _dfa.isAcceptState(_currentState);
+        }
+
+        // 是否已经处于死状态，处于死状态时之后的任何输入都不会被接受
+        bool isDead() const
+        {
+            return _currentState == DeadState;
+        }
+
+        // 是否已经处于接受汇点，处于接受汇点时之后无论输入什么都会被接受
+        bool isAcceptSink() const
+        {
+            return _currentState == _dfa._acceptSinkState && _currentState != DeadState;
+        }
+
+        // 当前状态（的行偏移）
+        uint32_t getCurrentState() const
+        {
+            return _currentState;
+        }
+
+    private:
+        bool isDecided(uint32_t state) const
+        {
+            return state == DeadState || state == _dfa._acceptSinkState;
+        }
+
+    private:
+        const CompiledDFA& _dfa;
+        uint32_t _currentState;
+    };
+
+private:
+    CompiledDFA() = default;
+
+    uint32_t toRowOffset(StateId state) const
+    {
+        return static_cast<uint32_t>((state + 1) * _rowWidth);
+    }
+
+    void bindOwnedStorage()
+    {
+        _table = _ownedTable.data();
+        _acceptStateBits = _ownedAcceptStateBits.data();
+        _nameOffsets = _ownedNameOffsets.empty() ? nullptr : _ownedNameOffsets.data();
+        _nameChars = _ownedNameChars;
+    }
+
+private:
+    size_t _stateCount = 0;
+    size_t _rowWidth = 0;
+    // 字节到字节类的映射表
+    std::array<ByteClassId, 256> _classMap{};
+    uint32_t _initialState = 0;
+    uint32_t _acceptSinkState = DeadState;
+
+    // 从DFA构造时拥有的存储，从序列化的数据加载时为空
+    std::vector<uint32_t> _ownedTable;
+    std::vector<uint64_t> _ownedAcceptStateBits;
+    std::vector<uint32_t> _ownedNameOffsets;
+    std::string _ownedNameChars;
+
+    // 状态转移表，下标为 行偏移 + 字节类
+    const uint32_t* _table = nullptr;
+    // 可接受状态的位图，下标为编译后的状态编号
+    const uint64_t* _acceptStateBits = nullptr;
+    // 状态名称，编译后的状态i的名称为_nameChars[_nameOffsets[i], _nameOffsets[i + 1])，没有状态名称时_nameOffsets为空
+    const uint32_t* _nameOffsets = nullptr;
+    std::string_view _nameChars;
+};
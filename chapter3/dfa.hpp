@@ -1,18 +1,24 @@
 ﻿#pragma once
 
+#include <algorithm>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 #include <map>
 
+#include "byte_classes.hpp"
 #include "fa_common.hpp"
+#include "fa_statistics.hpp"
 
 // 有限状态机（状态转移）规则
 // 定义某个状态下接收到某个输入时转移到哪个状态
+// 规则使用状态名称描述，构造DFA时会被驻留为整数编号
 class DFARule
 {
 public:
@@ -83,369 +89,766 @@ private:
     const std::unordered_set<State> _acceptStateSet;
 };
 
+// 整数编号下的状态转移，输入为字节类
+struct DFATransition
+{
+    StateId startState;
+    ByteClassId input;
+    StateId nextState;
+};
+
 // 有限状态机，由状态转移规则和可接受的中终止状态组成
 class DFA
 {
 public:
+    // 使用状态名称定义DFA，名称会被驻留为整数编号，并作为展示名称保留
     DFA(State initialState, std::vector<DFARule> rules, DFAAcceptStates acceptStates)
-        : _initialState(std::move(initialState)),
-          _rules(std::move(rules)),
-          _acceptStates(std::move(acceptStates)),
-          _transformRelation(generateTransformRelation())
-    {}
+    {
+        StateTable stateTable;
+        _initialState = stateTable.intern(initialState);
+
+        ByteClassBuilder byteClassBuilder;
+        for (const auto& rule : rules)
+        {
+            byteClassBuilder.add(rule.input());
+        }
+        _byteClasses = byteClassBuilder.build();
+
+        std::vector<DFATransition> transitions;
+        transitions.reserve(rules.size());
+        for (const auto& rule : rules)
+        {
+            const auto startState = stateTable.intern(rule.startState());
+            const auto nextState = stateTable.intern(rule.nextState());
+            transitions.push_back({startState, _byteClasses.getClass(rule.input()), nextState});
+        }
+
+        std::vector<StateId> acceptStateList;
+        for (const auto& state : acceptStates.getStateSet())
+        {
+            acceptStateList.push_back(stateTable.intern(state));
+        }
+
+        _stateCount = stateTable.size();
+        _stateNames = stateTable.releaseNames();
+        initialize(std::move(transitions), acceptStateList);
+    }
 
-    DFA(DFA&& rvalue)
-        : _initialState(std::move(rvalue._initialState)),
-          _rules(std::move(rvalue._rules)),
-          _acceptStates(std::move(rvalue._acceptStates)),
-          _transformRelation(generateTransformRelation())
+    // 直接使用整数编号定义DFA，状态编号必须小于stateCount，状态转移的输入为byteClasses中的字节类
+    // stateNames为可选的展示名称表
+    DFA(StateId initialState,
+        size_t stateCount,
+        std::vector<DFATransition> transitions,
+        const std::vector<StateId>& acceptStates,
+        ByteClasses byteClasses,
+        std::vector<State> stateNames = {})
+        : _initialState(initialState),
+          _stateCount(stateCount),
+          _byteClasses(std::move(byteClasses)),
+          _stateNames(std::move(stateNames))
     {
+        initialize(std::move(transitions), acceptStates);
     }
 
-    const auto& getInitialState() const
+    StateId getInitialState() const
     {
         return _initialState;
     }
 
-    const auto& getAcceptStates() const
+    size_t getStateCount() const
+    {
+        return _stateCount;
+    }
+
+    bool isAcceptState(StateId state) const
+    {
+        return _acceptStateFlags[state];
+    }
+
+    // 是否是接受汇点：到达之后无论再输入什么都会被接受（终止状态，任意字节类都有转移，且转移到的状态也都是接受汇点）
+    bool isAcceptSink(StateId state) const
+    {
+        return _acceptSinkFlags[state];
+    }
+
+    const std::vector<StateId>& getAcceptStateList() const
+    {
+        return _acceptStateList;
+    }
+
+    // 获取全部状态转移，按照[开始状态、输入]排序
+    const std::vector<DFATransition>& getTransitions() const
+    {
+        return _transitions;
+    }
+
+    // 获取从某状态开始的状态转移
+    std::span<const DFATransition> getTransitions(StateId state) const
+    {
+        return std::span<const DFATransition>(_transitions).subspan(
+                _transitionOffsets[state], _transitionOffsets[state + 1] - _transitionOffsets[state]);
+    }
+
+    // 获取字节类划分，状态转移的输入都是其中的字节类
+    const ByteClasses& getByteClasses() const
+    {
+        return _byteClasses;
+    }
+
+    // 获取某状态下接受某输入转移到的状态，不存在转移时返回InvalidStateId
+    StateId getNextState(StateId state, InputType input) const
+    {
+        return getNextStateByClass(state, _byteClasses.getClass(input));
+    }
+
+    // 获取某状态下接受某字节类转移到的状态，不存在转移时返回InvalidStateId
+    StateId getNextStateByClass(StateId state, ByteClassId input) const
     {
-        return _acceptStates;
+        const auto transitions = getTransitions(state);
+        const auto it = std::lower_bound(transitions.begin(), transitions.end(), input, [](const auto& transition, ByteClassId value) {
+            return transition.input < value;
+        });
+        if (it == transitions.end() || it->input != input)
+        {
+            return InvalidStateId;
+        }
+        return it->nextState;
+    }
+
+    const std::vector<State>& getStateNames() const
+    {
+        return _stateNames;
     }
 
-    const auto& getRules() const
+    State getStateName(StateId state) const
     {
-        return _rules;
+        return getStateDisplayName(_stateNames, state);
     }
 
     // 裁剪掉无法到达的状态及其状态转移规则
     auto trim() const
     {
         // 待处理状态
-        std::vector<State> pedingState = {_initialState};
+        std::vector<StateId> pedingState = {_initialState};
         // 记录当前访问过的状态节点，这些节点也是能够到达的节点，这些节点之外的节点都是无法到达的.
-        std::set<State> visitedState;
+        std::vector<bool> visitedState(_stateCount, false);
+        visitedState[_initialState] = true;
 
         while (!pedingState.empty())
         {
             auto state = pedingState.back();
-            visitedState.insert(state);
             pedingState.pop_back();
 
-            const auto it = _transformRelation.find(state);
-            if (it == _transformRelation.end())
+            for (const auto& transition : getTransitions(state))
             {
-                continue;
+                if (!visitedState[transition.nextState])
+                {
+                    visitedState[transition.nextState] = true;
+                    pedingState.push_back(transition.nextState);
+                }
             }
+        }
 
-            for (const auto& [input, nextState] : it->second)
+        // 为能够到达的状态重新分配稠密的编号（保持原有的相对顺序）
+        std::vector<StateId> insteadOf(_stateCount, InvalidStateId);
+        std::vector<State> newStateNames;
+        StateId newStateCount = 0;
+        for (StateId state = 0; state < _stateCount; state++)
+        {
+            if (visitedState[state])
             {
-                if (!visitedState.contains(nextState))
+                insteadOf[state] = newStateCount++;
+                if (state < _stateNames.size())
                 {
-                    pedingState.push_back(nextState);
+                    newStateNames.push_back(_stateNames[state]);
                 }
             }
         }
 
-        auto transformRelation = _transformRelation;
         // 从状态转移中删除无法访问的节点的状态转移
-        for (auto it = transformRelation.begin(); it != transformRelation.end();)
+        std::vector<DFATransition> transitions;
+        for (const auto& transition : _transitions)
         {
-            if (!visitedState.contains(it->first))
-            {
-                // 如果此节点没有在之前被访问过，则可以删除从它开始的这条状态转移关系
-                it = transformRelation.erase(it);
-            }
-            else
+            if (visitedState[transition.startState])
             {
-                it++;
+                transitions.push_back({insteadOf[transition.startState], transition.input, insteadOf[transition.nextState]});
             }
         }
 
-        std::unordered_set<State> newFinalStateSet;
-        if (_acceptStates.accept(_initialState))
+        std::vector<StateId> newFinalStateList;
+        for (const auto state : _acceptStateList)
         {
-            newFinalStateSet.insert(_initialState);
+            if (visitedState[state])
+            {
+                newFinalStateList.push_back(insteadOf[state]);
+            }
         }
 
-        // 根据最新的状态转移表构建转移规则列表
-        std::vector<DFARule> rules;
-        for (const auto& [state, transfrom] : transformRelation)
+        if (newStateNames.size() != newStateCount)
         {
-            for (const auto& [input, nextState] : transfrom)
-            {
-                rules.push_back(DFARule(state, input, nextState));
-                if (_acceptStates.accept(nextState))
-                {
-                    newFinalStateSet.insert(nextState);
-                }
-            }
+            newStateNames.clear();
         }
 
-        return DFA(_initialState, std::move(rules), DFAAcceptStates(newFinalStateSet));
+        return DFA(insteadOf[_initialState], newStateCount, std::move(transitions), newFinalStateList, _byteClasses, std::move(newStateNames));
     }
 
-    // 获取最小化的DFA
-    auto minimize() const
+    // 获取能够到达终止状态的状态（在反向的状态转移上从全部终止状态开始遍历）
+    // 其余的状态无论之后输入什么都不会被接受，与缺失转移所隐含的死状态等价
+    std::vector<bool> getLiveStates() const
     {
-        const auto inputSet = getInputSet();
-
-        std::vector<std::set<State>> groupList;
-        std::vector<std::set<State>> newGroupList;
-
+        std::vector<uint32_t> reverseOffsets(_stateCount + 1, 0);
+        for (const auto& transition : _transitions)
         {
-            // 收集所有转换关系中的开始状态集合，这些状态才是允许合并的
-            std::set<State> stateSet;
-            for (const auto& [state, _] : _transformRelation)
-            {
-                stateSet.insert(state);
-            }
-            groupList.push_back(stateSet);
+            reverseOffsets[transition.nextState + 1]++;
+        }
+        for (size_t i = 0; i < _stateCount; i++)
+        {
+            reverseOffsets[i + 1] += reverseOffsets[i];
+        }
+        std::vector<StateId> reverseStates(_transitions.size());
+        auto position = reverseOffsets;
+        for (const auto& transition : _transitions)
+        {
+            reverseStates[position[transition.nextState]++] = transition.startState;
         }
 
-        // 根据每一个输入划分状态分组
-        for (const auto& input : inputSet)
+        std::vector<bool> live(_stateCount, false);
+        std::vector<StateId> pendingStates;
+        for (const auto state : _acceptStateList)
         {
-            for (const auto& group : groupList)
+            live[state] = true;
+            pendingStates.push_back(state);
+        }
+        while (!pendingStates.empty())
+        {
+            const auto state = pendingStates.back();
+            pendingStates.pop_back();
+            for (auto i = reverseOffsets[state]; i < reverseOffsets[state + 1]; i++)
             {
-                // 如果此分组的个数不超过1，则不需要进行尝试拆分
-                if (group.size() <= 1)
-                {
-                    newGroupList.push_back(group);
-                    continue;
-                }
-
-                std::map<State, std::set<State>> eatchSet;
-                std::set<State> cantEatchState;
-
-                for (const auto& state : group)
-                {
-                    const auto it = _transformRelation.find(state);
-                    if (it == _transformRelation.end())
-                    {
-                        // 这里应抛异常，按理不会存在这个分支情况
-                        cantEatchState.insert(state);
-                        continue;
-                    }
-                    const auto nextStateIt = it->second.find(input);
-                    if (nextStateIt == it->second.end())
-                    {
-                        // 如果是正规DFA，则也不应该出现此情况，但我们这里不做严格要求
-                        cantEatchState.insert(state);
-                        continue;
-                    }
-                    // 记录能到达某个状态的起始状态集
-                    eatchSet[nextStateIt->second].insert(state);
-                }
-
-                for (const auto& [_, startStateSet] : eatchSet)
+                if (!live[reverseStates[i]])
                 {
-                    newGroupList.push_back(startStateSet);
-                }
-                if (!cantEatchState.empty())
-                {
-                    newGroupList.push_back(cantEatchState);
+                    live[reverseStates[i]] = true;
+                    pendingStates.push_back(reverseStates[i]);
                 }
             }
-
-            groupList = newGroupList;
-            newGroupList.clear();
         }
+        return live;
+    }
 
-        // 根据分组构建替换表
-        std::map<State, State> insteadOf;
-        for (auto& group : groupList)
+    // 裁剪掉无法到达的状态与无法到达终止状态的状态，并把全部接受汇点合并为一个
+    // 转移到无法到达终止状态的状态的转移被删除，即全部死状态合并为缺失转移所隐含的唯一死状态；
+    // 合并后的接受汇点只有转移到自身的状态转移。起始状态总是保留，剩余状态保持原有的相对顺序
+    DFA prune() const
+    {
+        const auto live = getLiveStates();
+        auto acceptSink = InvalidStateId;
+        for (StateId state = 0; state < _stateCount && acceptSink == InvalidStateId; state++)
         {
-            for (const auto& state : group)
+            if (_acceptSinkFlags[state])
             {
-                insteadOf[state] = convertCombinationStateToString(group);
+                acceptSink = state;
             }
         }
 
-        // 根据最新的状态转移表构建新的转移规则列表
-        std::vector<DFARule> rules;
-        for (const auto& rule : _rules)
+        std::vector<DFATransition> transitions;
+        for (const auto& transition : _transitions)
         {
-            auto startState = rule.startState();
-            if (const auto it = insteadOf.find(startState); it != insteadOf.end())
+            // 只保留合并后的接受汇点自身的转移
+            if (!live[transition.nextState] || (_acceptSinkFlags[transition.startState] && transition.startState != acceptSink))
             {
-                startState = it->second;
+                continue;
             }
+            const auto nextState = _acceptSinkFlags[transition.nextState] ? acceptSink : transition.nextState;
+            transitions.push_back({transition.startState, transition.input, nextState});
+        }
 
-            auto nextState = rule.nextState();
-            if (const auto it = insteadOf.find(nextState); it != insteadOf.end())
-            {
-                nextState = it->second;
-            }
+        const auto initialState = _acceptSinkFlags[_initialState] ? acceptSink : _initialState;
+        return DFA(initialState, _stateCount, std::move(transitions), _acceptStateList, _byteClasses, _stateNames).trim();
+    }
 
-            rules.push_back(DFARule(startState, rule.input(), nextState));
-        }
+    // 获取最小化的DFA
+    // 使用Hopcroft划分细化算法，时间复杂度为O(n·k·log n)，其中n为状态数，k为字节类数：
+    // 1. 先裁剪掉无法到达的状态，并引入一个隐含的死状态，把所有缺失的转移都视为转移到死状态，得到完整的DFA。
+    // 2. 初始划分为[终止状态、非终止状态]两组，并把较小的一组与每个字节类组成的(分组, 字节类)放入待处理列表。
+    // 3. 每次从待处理列表中取出一个(分组A, 字节类c)作为划分者，找出所有接受c之后转移到A中的状态X，
+    //    对于每一个与X相交但不被X包含的分组Y，将其拆分为 Y∩X 与 Y-X 两组；
+    //    若(Y, a)已在待处理列表中，则把新的分组也加入，否则只需加入两者中较小的一组（这正是log n的来源）。
+    // 4. 待处理列表为空时，每个分组内的状态都是等价状态。与死状态在同一分组的状态无法到达终止状态，它们的转移直接删除。
+    // 5. 以起始状态所在分组为起点，按广度优先的顺序为分组编号，构造新的DFA，因此等价的DFA最小化之后的结果完全相同。
+    DFA minimize() const
+    {
+        const auto trimmed = trim();
+        return trimmed.minimizeReachable();
+    }
 
-        // 获取新的起始状态
-        auto newInitialState = _initialState;
-        if (auto it = insteadOf.find(newInitialState); it != insteadOf.end())
+    // 合并在所有状态下转移行为都相同的字节类，得到更小的字母表
+    DFA compressByteClasses() const
+    {
+        // 字节类的签名：在每个状态下接受此字节类所转移到的状态
+        std::map<std::vector<StateId>, ByteClassId> signatureClasses;
+        std::vector<ByteClassId> mergeTo(_byteClasses.getClassCount());
+        for (size_t byteClass = 0; byteClass < _byteClasses.getClassCount(); byteClass++)
         {
-            newInitialState = it->second;
+            std::vector<StateId> signature(_stateCount);
+            for (StateId state = 0; state < _stateCount; state++)
+            {
+                signature[state] = getNextStateByClass(state, static_cast<ByteClassId>(byteClass));
+            }
+            const auto [it, _] = signatureClasses.try_emplace(std::move(signature), static_cast<ByteClassId>(byteClass));
+            mergeTo[byteClass] = it->second;
         }
 
-        // 构建新的终止状态（因为某些终止状态也是一些关系的起始状态，也存在被合并的可能，所以可能需要替换）
-        std::unordered_set<State> newFinalStateSet;
-        for (const auto& oldFinalState : _acceptStates.getStateSet())
+        auto byteClasses = _byteClasses.merge(mergeTo);
+
+        // 每个合并后的字节类只需保留其中一个原字节类的状态转移
+        std::vector<DFATransition> transitions;
+        for (const auto& transition : _transitions)
         {
-            if (const auto it = insteadOf.find(oldFinalState); it != insteadOf.end())
-            {
-                newFinalStateSet.insert(it->second);
-            }
-            else
+            if (mergeTo[transition.input] == transition.input)
             {
-                newFinalStateSet.insert(oldFinalState);
+                transitions.push_back({transition.startState, byteClasses.getClass(_byteClasses.getRepresentative(transition.input)), transition.nextState});
             }
         }
 
-        return DFA(newInitialState, std::move(rules), DFAAcceptStates(newFinalStateSet));
+        return DFA(_initialState, _stateCount, std::move(transitions), _acceptStateList, std::move(byteClasses), _stateNames);
     }
 
-    std::set<InputType> getInputSet() const
+    // 获取状态转移中出现的输入（字节类）集合
+    std::set<ByteClassId> getInputSet() const
     {
-        std::set<InputType> inputSet;
-        for (const auto& rule : _rules)
+        std::set<ByteClassId> inputSet;
+        for (const auto& transition : _transitions)
         {
-            inputSet.insert(rule.input());
+            inputSet.insert(transition.input);
         }
         return inputSet;
     }
 
-    // 访问状态机中的所有状态
-    std::set<State> getStateSet() const
-    {
-        std::set<State> stateSet;
-        for (const auto& rule : _rules)
-        {
-            stateSet.insert(rule.startState());
-            stateSet.insert(rule.nextState());
-        }
-        return stateSet;
-    }
-
     // 检查此有限状态机的定义是否有效
     bool valid() const
     {
-        // 记录状态集合
-        std::unordered_set<State> stateSet;
+        // 记录出现在状态转移中的状态
+        std::vector<bool> stateSet(_stateCount, false);
         // 记录符号集合
-        std::unordered_set<InputType> inputSet;
+        const auto inputSet = getInputSet();
 
-        // 1. 从规则中收集状态集合、符号集合
+        // 1. 从规则中收集状态集合
         // 2. 检测是否存在重复的状态转移规则
         // 即存在相同的[开始状态、输入]的组合。如果存在重复则存在不确定性、二义性。（后话：NFA则允许重复的组合）
-        std::unordered_map<State, std::unordered_map<InputType, State>> stateRelation;
-        for (const auto& rule : _rules)
+        // 状态转移已经按照[开始状态、输入]排序，因此重复的组合一定相邻
+        for (size_t i = 0; i < _transitions.size(); i++)
         {
-            auto& transform = stateRelation[rule.startState()];
-            if (transform.contains(rule.input()))
+            const auto& transition = _transitions[i];
+            if (i > 0 && _transitions[i - 1].startState == transition.startState && _transitions[i - 1].input == transition.input)
             {
                 // 存在重复的状态转移 [startState, input]
                 return false;
             }
-            transform[rule.input()] = rule.nextState();
 
-            stateSet.insert(rule.startState());
-            stateSet.insert(rule.nextState());
-            inputSet.insert(rule.input());
+            stateSet[transition.startState] = true;
+            stateSet[transition.nextState] = true;
         }
 
-        if (!stateSet.contains(_initialState))
+        if (!stateSet[_initialState])
         {
             // 如果起始状态没在状态集合中则返回false
             return false;
         }
 
         // 检测状态转移是否满足DFA定义的约束，即满足(状态,输入)的任意组合都有且只有一个规则。
-        for (auto state : stateSet)
+        for (StateId state = 0; state < _stateCount; state++)
         {
-            if (_acceptStates.accept(state))
+            if (!stateSet[state] || isAcceptState(state))
             {
                 continue;
             }
-            const auto it = stateRelation.find(state);
-            if (it == stateRelation.end())
+            // 没有重复转移时，转移数量与符号数量相等即说明每一个符号都有转移
+            if (getTransitions(state).size() != inputSet.size())
             {
-                // 找不到以某状态作为开始的状态转移
+                // 在当前开始状态下没有找到针对某个输入符号的状态转移
                 return false;
             }
-            const auto& transform = (*it).second;
-
-            for (const auto& input : inputSet)
-            {
-                if (!transform.contains(input))
-                {
-                    // 在当前开始状态下没有找到针对某个输入符号的状态转移
-                    return false;
-                }
-            }
         }
 
         // 检查是否存在转移的下一个状态属于结束状态，若存在则返回“有效”，当前代码仅实现功能（不做优化）
-        for (const auto& [startState, transform] : stateRelation)
+        for (const auto& transition : _transitions)
         {
-            for (const auto& [input, nextState] : transform)
+            if (isAcceptState(transition.nextState))
             {
-                if (_acceptStates.accept(nextState))
-                {
-                    return true;
-                }
+                return true;
             }
         }
 
         return false;
     }
 
-    // 获取确定性状态转移表
-    const auto& getTransformRelation() const
-    {
-        return _transformRelation;
-    }
-
-
     // 判断从初始状态开始，此FA是否接受输入序列
     bool accept(const std::vector<InputType>& inputs) const
     {
         auto currentState = _initialState;
-        for (const auto& currentInput : inputs)
+        for (size_t position = 0; position < inputs.size(); position++)
         {
-            const auto it = _transformRelation.find(currentState);
-            if (it == _transformRelation.end())
+            currentState = getNextState(currentState, inputs[position]);
+            if (currentState == InvalidStateId)
             {
+                FA_STATISTICS_ADD(bytesProcessed, position + 1);
+                FA_STATISTICS_ADD(deadStateExits, 1);
                 return false;
             }
-            const auto nextStateIt = it->second.find(currentInput);
-            if (nextStateIt == it->second.end())
+            // 进入接受汇点之后结果已经确定，不需要处理剩余的输入
+            if (_acceptSinkFlags[currentState])
             {
-                return false;
+                FA_STATISTICS_ADD(bytesProcessed, position + 1);
+                return true;
             }
-            currentState = nextStateIt->second;
         }
+        FA_STATISTICS_ADD(bytesProcessed, inputs.size());
 
         // 处理完输入序列之后，判断当前状态是否属于终止状态（即可接受状态)
-        return _acceptStates.accept(currentState);
+        return isAcceptState(currentState);
     }
 
 private:
-    // 构造确定性状态转移表
-    std::map<State, std::map<InputType, State>> generateTransformRelation() const
+    // 对所有状态都可以到达的DFA进行最小化
+    DFA minimizeReachable() const
+    {
+        // 死状态的编号为_stateCount，状态总数为_stateCount + 1
+        const auto deadState = static_cast<StateId>(_stateCount);
+        const size_t stateCount = _stateCount + 1;
+
+        // 只有状态转移中出现过的字节类才可能拆分分组，其他字节类在所有状态下都转移到死状态
+        const auto inputSet = getInputSet();
+        const std::vector<ByteClassId> inputList(inputSet.begin(), inputSet.end());
+        const auto inputCount = inputList.size();
+
+        // 构造完整的DFA的反向转移：按[目标状态、字节类]排序，reverseOffsets[t]为转移到t的反向转移的起始位置
+        std::vector<std::pair<ByteClassId, StateId>> reverseTransitions;
+        std::vector<uint32_t> reverseOffsets(stateCount + 1, 0);
+        {
+            std::vector<StateId> targets(stateCount * inputCount, deadState);
+            for (const auto& transition : _transitions)
+            {
+                const auto index = std::lower_bound(inputList.begin(), inputList.end(), transition.input) - inputList.begin();
+                targets[transition.startState * inputCount + index] = transition.nextState;
+            }
+            for (const auto target : targets)
+            {
+                reverseOffsets[target + 1]++;
+            }
+            for (size_t i = 0; i < stateCount; i++)
+            {
+                reverseOffsets[i + 1] += reverseOffsets[i];
+            }
+            reverseTransitions.resize(targets.size());
+            auto position = reverseOffsets;
+            // 按照字节类的顺序填充，保证每个目标状态下的反向转移按字节类有序
+            for (size_t index = 0; index < inputCount; index++)
+            {
+                for (StateId state = 0; state < stateCount; state++)
+                {
+                    const auto target = targets[state * inputCount + index];
+                    reverseTransitions[position[target]++] = {static_cast<ByteClassId>(index), state};
+                }
+            }
+        }
+
+        // 可细化的划分：elements中每个分组占据连续的一段[blockBegin, blockEnd)
+        std::vector<StateId> elements(stateCount);
+        std::vector<uint32_t> location(stateCount);
+        std::vector<uint32_t> blockOf(stateCount);
+        std::vector<uint32_t> blockBegin;
+        std::vector<uint32_t> blockEnd;
+        // 划分过程中每个分组被标记的状态个数，被标记的状态位于分组的开头
+        std::vector<uint32_t> markedCount;
+
+        {
+            // 初始划分：非终止状态（包括死状态）在前，终止状态在后
+            uint32_t position = 0;
+            for (StateId state = 0; state < stateCount; state++)
+            {
+                if (state == deadState || !isAcceptState(state))
+                {
+                    elements[position++] = state;
+                }
+            }
+            const auto acceptBegin = position;
+            for (StateId state = 0; state < _stateCount; state++)
+            {
+                if (isAcceptState(state))
+                {
+                    elements[position++] = state;
+                }
+            }
+
+            blockBegin.push_back(0);
+            blockEnd.push_back(acceptBegin);
+            if (acceptBegin < stateCount)
+            {
+                blockBegin.push_back(acceptBegin);
+                blockEnd.push_back(static_cast<uint32_t>(stateCount));
+            }
+            markedCount.assign(blockBegin.size(), 0);
+
+            for (uint32_t block = 0; block < blockBegin.size(); block++)
+            {
+                for (auto i = blockBegin[block]; i < blockEnd[block]; i++)
+                {
+                    location[elements[i]] = i;
+                    blockOf[elements[i]] = block;
+                }
+            }
+        }
+
+        // 待处理的划分者(分组, 字节类)，以及其是否已在待处理列表中
+        std::vector<std::pair<uint32_t, uint32_t>> pendingSplitters;
+        std::vector<bool> pendingFlags(blockBegin.size() * inputCount, false);
+        const auto addSplitter = [&](uint32_t block, uint32_t input) {
+            if (!pendingFlags[block * inputCount + input])
+            {
+                pendingFlags[block * inputCount + input] = true;
+                pendingSplitters.push_back({block, input});
+            }
+        };
+
+        if (blockBegin.size() == 2)
+        {
+            const uint32_t smallerBlock = (blockEnd[0] - blockBegin[0]) <= (blockEnd[1] - blockBegin[1]) ? 0 : 1;
+            for (uint32_t input = 0; input < inputCount; input++)
+            {
+                addSplitter(smallerBlock, input);
+            }
+        }
+
+        std::vector<StateId> splitterStates;
+        std::vector<uint32_t> touchedBlocks;
+        while (!pendingSplitters.empty())
+        {
+            const auto [splitter, input] = pendingSplitters.back();
+            pendingSplitters.pop_back();
+            pendingFlags[splitter * inputCount + input] = false;
+            FA_STATISTICS_ADD(minimizationRounds, 1);
+
+            // 先复制划分者中的状态，因为标记的过程会调整elements中的顺序
+            splitterStates.assign(elements.begin() + blockBegin[splitter], elements.begin() + blockEnd[splitter]);
+
+            // 标记所有接受input之后转移到划分者中的状态
+            for (const auto target : splitterStates)
+            {
+                const auto begin = reverseTransitions.begin() + reverseOffsets[target];
+                const auto end = reverseTransitions.begin() + reverseOffsets[target + 1];
+                auto it = std::lower_bound(begin, end, std::make_pair(static_cast<ByteClassId>(input), StateId(0)));
+                for (; it != end && it->first == input; ++it)
+                {
+                    const auto state = it->second;
+                    const auto block = blockOf[state];
+                    const auto markedEnd = blockBegin[block] + markedCount[block];
+                    if (location[state] < markedEnd)
+                    {
+                        continue;
+                    }
+                    // 将此状态交换到分组中已标记部分的末尾
+                    const auto other = elements[markedEnd];
+                    std::swap(elements[location[state]], elements[markedEnd]);
+                    location[other] = location[state];
+                    location[state] = markedEnd;
+                    if (markedCount[block]++ == 0)
+                    {
+                        touchedBlocks.push_back(block);
+                    }
+                }
+            }
+
+            // 拆分被部分标记的分组，新的分组总是两者中较小的那一部分
+            for (const auto block : touchedBlocks)
+            {
+                const auto marked = markedCount[block];
+                markedCount[block] = 0;
+                const auto size = blockEnd[block] - blockBegin[block];
+                if (marked == size)
+                {
+                    continue;
+                }
+
+                const auto newBlock = static_cast<uint32_t>(blockBegin.size());
+                if (marked <= size - marked)
+                {
+                    blockBegin.push_back(blockBegin[block]);
+                    blockEnd.push_back(blockBegin[block] + marked);
+                    blockBegin[block] += marked;
+                }
+                else
+                {
+                    blockBegin.push_back(blockBegin[block] + marked);
+                    blockEnd.push_back(blockEnd[block]);
+                    blockEnd[block] = blockBegin[block] + marked;
+                }
+                markedCount.push_back(0);
+                pendingFlags.resize(pendingFlags.size() + inputCount, false);
+                for (auto i = blockBegin[newBlock]; i < blockEnd[newBlock]; i++)
+                {
+                    blockOf[elements[i]] = newBlock;
+                }
+
+                for (uint32_t a = 0; a < inputCount; a++)
+                {
+                    // 若原分组已在待处理列表中，则新分组也需要处理；否则只需要处理较小的新分组
+                    addSplitter(newBlock, a);
+                }
+            }
+            touchedBlocks.clear();
+        }
+
+        // 以起始状态所在的分组为起点，按广度优先的顺序为分组编号，与死状态同组的分组不保留
+        const auto deadBlock = blockOf[deadState];
+        std::vector<StateId> newStateOfBlock(blockBegin.size(), InvalidStateId);
+        std::vector<uint32_t> blockQueue;
+        std::vector<DFATransition> transitions;
+        std::vector<StateId> newFinalStateList;
+
+        if (blockOf[_initialState] == deadBlock)
+        {
+            // 此DFA不接受任何输入
+            return DFA(0, 1, {}, {}, _byteClasses);
+        }
+
+        newStateOfBlock[blockOf[_initialState]] = 0;
+        blockQueue.push_back(blockOf[_initialState]);
+        for (size_t i = 0; i < blockQueue.size(); i++)
+        {
+            const auto block = blockQueue[i];
+            // 分组内的状态都是等价的，使用第一个状态的转移即可
+            const auto representative = elements[blockBegin[block]];
+            if (isAcceptState(representative))
+            {
+                newFinalStateList.push_back(newStateOfBlock[block]);
+            }
+            for (const auto& transition : getTransitions(representative))
+            {
+                const auto nextBlock = blockOf[transition.nextState];
+                if (nextBlock == deadBlock)
+                {
+                    continue;
+                }
+                if (newStateOfBlock[nextBlock] == InvalidStateId)
+                {
+                    newStateOfBlock[nextBlock] = static_cast<StateId>(blockQueue.size());
+                    blockQueue.push_back(nextBlock);
+                }
+                transitions.push_back({newStateOfBlock[block], transition.input, newStateOfBlock[nextBlock]});
+            }
+        }
+
+        // 状态合并之后，原本被区分开的字节类可能在所有状态下的行为都相同了，因此再合并一次字节类
+        return DFA(0, blockQueue.size(), std::move(transitions), newFinalStateList, _byteClasses).compressByteClasses();
+    }
+
+    // 构造确定性状态转移表：按[开始状态、输入]对转移排序，并记录每个状态的转移区间
+    void initialize(std::vector<DFATransition> transitions, const std::vector<StateId>& acceptStates)
+    {
+        std::stable_sort(transitions.begin(), transitions.end(), [](const auto& a, const auto& b) {
+            return std::tie(a.startState, a.input) < std::tie(b.startState, b.input);
+        });
+        _transitions = std::move(transitions);
+
+        _transitionOffsets.assign(_stateCount + 1, 0);
+        for (const auto& transition : _transitions)
+        {
+            _transitionOffsets[transition.startState + 1]++;
+        }
+        for (size_t i = 0; i < _stateCount; i++)
+        {
+            _transitionOffsets[i + 1] += _transitionOffsets[i];
+        }
+
+        _acceptStateFlags.assign(_stateCount, false);
+        for (const auto state : acceptStates)
+        {
+            if (!_acceptStateFlags[state])
+            {
+                _acceptStateFlags[state] = true;
+                _acceptStateList.push_back(state);
+            }
+        }
+
+        computeAcceptSinkFlags();
+    }
+
+    // 计算接受汇点：先把所有转移完整的终止状态作为候选，再反复排除能转移到非候选状态的候选，剩下的就是接受汇点
+    // 没有候选时（绝大多数DFA）不需要建立反向转移
+    void computeAcceptSinkFlags()
     {
-        std::map<State, std::map<InputType, State>> transformMap;
-        for (const auto& rule : _rules)
+        _acceptSinkFlags.assign(_stateCount, false);
+        bool hasCandidate = false;
+        for (const auto state : _acceptStateList)
+        {
+            if (getTransitions(state).size() == _byteClasses.getClassCount())
+            {
+                _acceptSinkFlags[state] = true;
+                hasCandidate = true;
+            }
+        }
+        if (!hasCandidate)
+        {
+            return;
+        }
+
+        // 候选状态的反向转移：reverseStates[reverseOffsets[t], reverseOffsets[t + 1])为能转移到t的候选状态
+        std::vector<uint32_t> reverseOffsets(_stateCount + 1, 0);
+        for (const auto& transition : _transitions)
+        {
+            if (_acceptSinkFlags[transition.startState])
+            {
+                reverseOffsets[transition.nextState + 1]++;
+            }
+        }
+        for (size_t i = 0; i < _stateCount; i++)
         {
-            transformMap[rule.startState()][rule.input()] = rule.nextState();
+            reverseOffsets[i + 1] += reverseOffsets[i];
+        }
+        std::vector<StateId> reverseStates(reverseOffsets.back());
+        auto position = reverseOffsets;
+        for (const auto& transition : _transitions)
+        {
+            if (_acceptSinkFlags[transition.startState])
+            {
+                reverseStates[position[transition.nextState]++] = transition.startState;
+            }
+        }
+
+        std::vector<StateId> pendingStates;
+        for (StateId state = 0; state < _stateCount; state++)
+        {
+            if (!_acceptSinkFlags[state])
+            {
+                pendingStates.push_back(state);
+            }
+        }
+        while (!pendingStates.empty())
+        {
+            const auto state = pendingStates.back();
+            pendingStates.pop_back();
+            for (auto i = reverseOffsets[state]; i < reverseOffsets[state + 1]; i++)
+            {
+                if (_acceptSinkFlags[reverseStates[i]])
+                {
+                    _acceptSinkFlags[reverseStates[i]] = false;
+                    pendingStates.push_back(reverseStates[i]);
+                }
+            }
         }
-        return transformMap;
     }
 
 
 private:
-    const State _initialState;
-    const std::vector<DFARule> _rules;
-    const DFAAcceptStates _acceptStates;
-
-    const std::map<State, std::map<InputType, State>> _transformRelation;
+    StateId _initialState;
+    size_t _stateCount;
+    ByteClasses _byteClasses;
+    std::vector<DFATransition> _transitions;
+    // 状态state的转移位于 _transitions[_transitionOffsets[state], _transitionOffsets[state + 1])
+    std::vector<uint32_t> _transitionOffsets;
+    std::vector<bool> _acceptStateFlags;
+    std::vector<StateId> _acceptStateList;
+    // 每个状态是否是接受汇点，构造时计算
+    std::vector<bool> _acceptSinkFlags;
+    std::vector<State> _stateNames;
 };
@@ -0,0 +1,176 @@
+﻿#pragma once
+
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dfa.hpp"
+
+// 根据DFA生成直接编码（direct-coded）的C++匹配函数
+// 每个状态是一个标号，状态转移是goto，不需要查表，适合状态较少的DFA
+namespace dfa2cpp {
+
+// 连续字节数超过该值的区间使用范围比较，否则展开为case标签
+constexpr size_t MaxCaseRangeSize = 4;
+
+// 以字节区间[first, last]转移到nextState，nextState为InvalidStateId表示拒绝（进入死状态）
+struct ByteRangeTransition
+{
+    size_t first;
+    size_t last;
+    StateId nextState;
+};
+
+// 获取某状态下按照字节顺序合并后的转移区间，覆盖全部256个字节
+static std::vector<ByteRangeTransition> getRangeTransitions(const DFA& dfa, StateId state)
+{
+    std::vector<ByteRangeTransition> ranges;
+    for (size_t byte = 0; byte < 256; byte++)
+    {
+        const auto nextState = dfa.getNextState(state, static_cast<InputType>(byte));
+        if (!ranges.empty() && ranges.back().nextState == nextState)
+        {
+            ranges.back().last = byte;
+        }
+        else
+        {
+            ranges.push_back({byte, byte, nextState});
+        }
+    }
+    return ranges;
+}
+
+// 进入死状态时直接拒绝，进入接受汇点时直接接受，不需要再读取剩余的输入
+static std::string getJump(const DFA& dfa, StateId nextState)
+{
+    if (nextState == InvalidStateId)
+    {
+        return "return false;";
+    }
+    return dfa.isAcceptSink(nextState) ? "return true;" : std::format("goto state{};", nextState);
+}
+
+// 生成一个独立的C++函数：inline bool functionName(std::string_view inputs)，判断整个输入是否被DFA接受
+// 每个状态中，覆盖字节最多的目标作为switch的default，较长的区间使用范围比较，其余字节展开为case标签
+// 生成之前先裁剪DFA（DFA::prune），无法到达终止状态的状态都成为死状态
+static std::string dfa2cpp(const DFA& source, std::string_view functionName = "match")
+{
+    const auto dfa = source.prune();
+
+    // 只生成从初始状态能够到达的状态，避免出现未使用的标号；接受汇点不需要标号（起始状态除外）
+    std::vector<bool> reachable(dfa.getStateCount(), false);
+    std::vector<StateId> pendingStates = {dfa.getInitialState()};
+    reachable[dfa.getInitialState()] = true;
+    while (!pendingStates.empty())
+    {
+        const auto state = pendingStates.back();
+        pendingStates.pop_back();
+        if (dfa.isAcceptSink(state))
+        {
+            continue;
+        }
+        for (const auto& transition : dfa.getTransitions(state))
+        {
+            if (!reachable[transition.nextState])
+            {
+                reachable[transition.nextState] = true;
+                pendingStates.push_back(transition.nextState);
+            }
+        }
+    }
+
+    std::string code = "#include <string_view>\n\n";
+    code += std::format("inline bool {}(std::string_view inputs)\n{{\n", functionName);
+    code += "    auto current = reinterpret_cast<const unsigned char*>(inputs.data());\n";
+    code += "    const auto end = current + inputs.size();\n";
+    code += std::format("    goto state{};\n", dfa.getInitialState());
+
+    for (StateId state = 0; state < dfa.getStateCount(); state++)
+    {
+        if (!reachable[state] || (dfa.isAcceptSink(state) && state != dfa.getInitialState()))
+        {
+            continue;
+        }
+
+        code += std::format("state{}:\n", state);
+        if (dfa.isAcceptSink(state))
+        {
+            code += "    return true;\n";
+            continue;
+        }
+        code += std::format("    if (current == end)\n        return {};\n", dfa.isAcceptState(state) ? "true" : "false");
+
+        const auto ranges = getRangeTransitions(dfa, state);
+        std::vector<size_t> byteCounts(dfa.getStateCount() + 1, 0);
+        for (const auto& range : ranges)
+        {
+            byteCounts[range.nextState == InvalidStateId ? dfa.getStateCount() : range.nextState] += range.last - range.first + 1;
+        }
+        auto defaultState = InvalidStateId;
+        auto defaultByteCount = byteCounts[dfa.getStateCount()];
+        for (StateId nextState = 0; nextState < dfa.getStateCount(); nextState++)
+        {
+            if (byteCounts[nextState] > defaultByteCount)
+            {
+                defaultState = nextState;
+                defaultByteCount = byteCounts[nextState];
+            }
+        }
+
+        std::string cases;
+        for (const auto& range : ranges)
+        {
+            if (range.nextState == defaultState || range.last - range.first + 1 > MaxCaseRangeSize)
+            {
+                continue;
+            }
+            for (auto byte = range.first; byte <= range.last; byte++)
+            {
+                cases += std::format("        case 0x{:02x}:\n", byte);
+            }
+            cases += std::format("            {}\n", getJump(dfa, range.nextState));
+        }
+        if (cases.empty())
+        {
+            code += "    current++;\n";
+        }
+        else
+        {
+            code += "    switch (*current++)\n    {\n";
+            code += cases;
+            code += "        default:\n";
+            code += "            break;\n";
+            code += "    }\n";
+        }
+
+        for (const auto& range : ranges)
+        {
+            if (range.nextState == defaultState || range.last - range.first + 1 <= MaxCaseRangeSize)
+            {
+                continue;
+            }
+            // current已经前进，比较的是刚读入的字节；区间在0或255处的一端不需要比较
+            std::string condition;
+            if (range.first == 0)
+            {
+                condition = std::format("current[-1] <= 0x{:02x}", range.last);
+            }
+            else if (range.last == 255)
+            {
+                condition = std::format("current[-1] >= 0x{:02x}", range.first);
+            }
+            else
+            {
+                condition = std::format("current[-1] >= 0x{:02x} && current[-1] <= 0x{:02x}", range.first, range.last);
+            }
+            code += std::format("    if ({})\n        {}\n", condition, getJump(dfa, range.nextState));
+        }
+        code += std::format("    {}\n", getJump(dfa, defaultState));
+    }
+    code += "}\n";
+
+    return code;
+}
+
+}// namespace dfa2cpp
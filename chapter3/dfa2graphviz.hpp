@@ -9,40 +9,35 @@ namespace dfa2graphviz {
 // 根据DFA生成graphviz
 static std::string dfa2graphviz(const DFA& dfa)
 {
-    auto initState = dfa.getInitialState();
+    const auto initState = dfa.getInitialState();
 
+    // 节点使用状态编号作为标识，使用展示名称作为标签
     std::vector<std::string> nodes;
-    auto stateSet = dfa.getStateSet();
-    for (const auto& state : stateSet)
+    for (StateId state = 0; state < dfa.getStateCount(); state++)
     {
-        if (state == initState && dfa.getAcceptStates().accept(state))
+        const auto name = dfa.getStateName(state);
+        if (state == initState && dfa.isAcceptState(state))
         {
-            nodes.push_back(std::format("{} [label=<{}>, shape=doublecircle, color=green]", state, state));
+            nodes.push_back(std::format("{} [label=<{}>, shape=doublecircle, color=green]", state, name));
         }
         else if (state == initState)
         {
-            nodes.push_back(std::format("{} [label=<{}>, shape=circle, color=green]", state, state));
+            nodes.push_back(std::format("{} [label=<{}>, shape=circle, color=green]", state, name));
         }
-        else if (dfa.getAcceptStates().accept(state))
+        else if (dfa.isAcceptState(state))
         {
-            nodes.push_back(std::format("{} [label=<{}>, shape=doublecircle, color=blue]", state, state));
+            nodes.push_back(std::format("{} [label=<{}>, shape=doublecircle, color=blue]", state, name));
         }
         else
         {
-            nodes.push_back(std::format("{} [label=<{}>, shape=circle]", state, state));
+            nodes.push_back(std::format("{} [label=<{}>, shape=circle]", state, name));
         }
     }
 
     std::vector<std::string> edges;
-    const auto& rules = dfa.getRules();
-    const auto& transformRelation = dfa.getTransformRelation();
-    for (const auto& [startState, transform] : transformRelation)
+    for (const auto& transition : dfa.getTransitions())
     {
-        for (const auto& [input, nextState] : transform)
-        {
-            edges.push_back(std::format("{}->{} [label=<{}>]", startState, nextState, input));
-
-        }
+        edges.push_back(std::format("{}->{} [label=<{}>]", transition.startState, transition.nextState, dfa.getByteClasses().toString(transition.input)));
     }
 
     std::string graphviz = "digraph G{\n";
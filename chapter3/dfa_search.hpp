@@ -0,0 +1,244 @@
+﻿#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "compiled_dfa.hpp"
+#include "literal_prefilter.hpp"
+#include "nfa2dfa.hpp"
+#include "nfa_concatenate.hpp"
+#include "nfa_repeat.hpp"
+#include "nfa_reverse.hpp"
+
+// 匹配结果，表示输入中的区间 [start, end)
+struct MatchSpan
+{
+    size_t start;
+    size_t end;
+
+    bool operator==(const MatchSpan&) const = default;
+};
+
+// 在输入中搜索（非锚定的）匹配，匹配规则为最左最长：起始位置最小的匹配中结束位置最大的那一个
+// 构造时编译三个DFA：
+// 1. 正向DFA：NFA本身，从某个起始位置开始锚定匹配，用于求最长的结束位置
+// 2. 非锚定正向DFA：在NFA前面隐含地加上.*（任意字节的重复），扫描一遍即可得到所有匹配中最后的结束位置，没有匹配时可以直接返回
+// 3. 反向DFA：NFA的反转，同样在前面加上.*。从最后的结束位置向前扫描，处于终止状态的位置即为某个匹配的起始位置
+// 因此搜索不需要在每个位置重新启动自动机，正向、反向各扫描一遍即可确定所有匹配的起始位置
+// 如果所有匹配都以同一个字面量开头，则改为使用字面量预过滤器直接跳到字面量出现的位置，只从这些位置开始锚定匹配，
+// 匹配稀疏时扫描速度接近内存带宽
+// 注意：从每个起始位置求最长匹配时需要扫描到正向DFA进入死状态为止，
+// 对于 a|a*b 这类可以一直延伸但最终不匹配的模式，findAll在最坏情况下仍然是O(n^2)的
+class DFASearcher
+{
+public:
+    explicit DFASearcher(const NFA& nfa)
+        : DFASearcher(nfa, nfa2dfa::convertNFA2DFA(nfa).minimize())
+    {
+    }
+
+    // 所有匹配都必须以之开头的字面量，没有时为空
+    const std::string& getLiteralPrefix() const
+    {
+        return _prefilter.getLiteral();
+    }
+
+    // 查找from之后的第一个（最左最长）匹配
+    // 没有字面量前缀时，每次调用都会扫描from之后的全部输入，需要查找所有匹配时应使用findAll
+    std::optional<MatchSpan> find(std::string_view inputs, size_t from = 0) const
+    {
+        if (!_prefilter.empty())
+        {
+            return findByPrefilter(inputs, from);
+        }
+
+        const auto lastEnd = findLastEnd(inputs, from);
+        if (!lastEnd)
+        {
+            return std::nullopt;
+        }
+
+        // 反向扫描到from为止，最后一个处于终止状态的位置就是最左的起始位置
+        auto state = _reverse.getInitialState();
+        auto start = _reverse.isAcceptState(state) ? lastEnd.value() : NoPosition;
+        for (auto position = lastEnd.value(); position > from; position--)
+        {
+            state = _reverse.getNextState(state, inputs[position - 1]);
+            if (_reverse.isAcceptState(state))
+            {
+                start = position - 1;
+            }
+        }
+
+        return MatchSpan{start, findLongestEnd(inputs, start, lastEnd.value()).value()};
+    }
+
+    // 查找from之后所有互不重叠的（最左最长）匹配
+    // 空匹配之后从下一个位置继续查找
+    std::vector<MatchSpan> findAll(std::string_view inputs, size_t from = 0) const
+    {
+        std::vector<MatchSpan> result;
+        if (!_prefilter.empty())
+        {
+            // 有字面量前缀时不存在空匹配，每次从上一个匹配的结束位置继续查找即可
+            for (auto match = findByPrefilter(inputs, from); match; match = findByPrefilter(inputs, match->end))
+            {
+                result.push_back(match.value());
+            }
+            return result;
+        }
+
+        const auto lastEnd = findLastEnd(inputs, from);
+        if (!lastEnd)
+        {
+            return result;
+        }
+
+        // 反向扫描一遍，在位图中标记所有匹配的起始位置（下标相对于from）
+        std::vector<uint64_t> startBits((lastEnd.value() - from) / 64 + 1, 0);
+        auto state = _reverse.getInitialState();
+        if (_reverse.isAcceptState(state))
+        {
+            setBit(startBits, lastEnd.value() - from);
+        }
+        for (auto position = lastEnd.value(); position > from; position--)
+        {
+            state = _reverse.getNextState(state, inputs[position - 1]);
+            if (_reverse.isAcceptState(state))
+            {
+                setBit(startBits, position - 1 - from);
+            }
+        }
+
+        // 从左到右依次取不小于当前位置的起始位置，求其最长匹配
+        for (auto position = from; position <= lastEnd.value();)
+        {
+            const auto start = findNextBit(startBits, position - from);
+            if (start == NoPosition)
+            {
+                break;
+            }
+            const auto end = findLongestEnd(inputs, start + from, lastEnd.value()).value();
+            result.push_back({start + from, end});
+            position = end > start + from ? end : end + 1;
+        }
+        return result;
+    }
+
+private:
+    static constexpr size_t NoPosition = SIZE_MAX;
+
+    DFASearcher(const NFA& nfa, const DFA& forward)
+        : _forward(forward),
+          _prefilter(extractLiteralPrefix(forward)),
+          _unanchoredForward(nfa2dfa::convertNFA2DFA(nfa_operator::concatenate(anyBytes(), nfa)).minimize()),
+          _reverse(nfa2dfa::convertNFA2DFA(nfa_operator::concatenate(anyBytes(), nfa_operator::reverse(nfa))).minimize())
+    {
+    }
+
+    // 接受任意字节序列的NFA，即 .*
+    static NFA anyBytes()
+    {
+        std::vector<NFATransition> transitions = {
+                {0, ByteRangeSet(ByteSet().set()), 1},
+        };
+        return nfa_operator::repeat(NFA(0, 2, std::move(transitions), {1}));
+    }
+
+    // 使用非锚定正向DFA扫描from之后的输入，返回所有匹配中最后的结束位置，没有匹配时返回空
+    std::optional<size_t> findLastEnd(std::string_view inputs, size_t from) const
+    {
+        if (from > inputs.size())
+        {
+            return std::nullopt;
+        }
+
+        std::optional<size_t> lastEnd;
+        auto state = _unanchoredForward.getInitialState();
+        if (_unanchoredForward.isAcceptState(state))
+        {
+            lastEnd = from;
+        }
+        for (auto position = from; position < inputs.size(); position++)
+        {
+            state = _unanchoredForward.getNextState(state, inputs[position]);
+            if (_unanchoredForward.isAcceptState(state))
+            {
+                lastEnd = position + 1;
+            }
+        }
+        return lastEnd;
+    }
+
+    // 依次从字面量出现的位置开始锚定匹配，第一个匹配成功的位置就是最左的起始位置
+    std::optional<MatchSpan> findByPrefilter(std::string_view inputs, size_t from) const
+    {
+        for (auto candidate = _prefilter.find(inputs, from); candidate != std::string_view::npos;
+             candidate = _prefilter.find(inputs, candidate + 1))
+        {
+            if (const auto end = findLongestEnd(inputs, candidate, inputs.size()))
+            {
+                return MatchSpan{candidate, end.value()};
+            }
+        }
+        return std::nullopt;
+    }
+
+    // 从起始位置开始锚定匹配，返回最长匹配的结束位置（任何匹配都不会超过limit），没有匹配时返回空
+    std::optional<size_t> findLongestEnd(std::string_view inputs, size_t start, size_t limit) const
+    {
+        std::optional<size_t> end;
+        auto state = _forward.getInitialState();
+        if (_forward.isAcceptState(state))
+        {
+            end = start;
+        }
+        for (auto position = start; position < limit; position++)
+        {
+            state = _forward.getNextState(state, inputs[position]);
+            if (state == CompiledDFA::DeadState)
+            {
+                break;
+            }
+            if (_forward.isAcceptState(state))
+            {
+                end = position + 1;
+            }
+        }
+        return end;
+    }
+
+    static void setBit(std::vector<uint64_t>& bits, size_t index)
+    {
+        bits[index / 64] |= uint64_t(1) << (index % 64);
+    }
+
+    // 查找不小于index的第一个被置位的下标
+    static size_t findNextBit(const std::vector<uint64_t>& bits, size_t index)
+    {
+        auto word = index / 64;
+        if (word >= bits.size())
+        {
+            return NoPosition;
+        }
+        auto current = bits[word] & (~uint64_t(0) << (index % 64));
+        while (current == 0)
+        {
+            if (++word == bits.size())
+            {
+                return NoPosition;
+            }
+            current = bits[word];
+        }
+        return word * 64 + std::countr_zero(current);
+    }
+
+private:
+    CompiledDFA _forward;
+    LiteralPrefilter _prefilter;
+    CompiledDFA _unanchoredForward;
+    CompiledDFA _reverse;
+};
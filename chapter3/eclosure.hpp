@@ -0,0 +1,306 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "fa_statistics.hpp"
+#include "nfa.hpp"
+
+// NFA全部状态的ε闭包
+// 先在ε转移构成的图上用Tarjan算法求强连通分量：同一分量中的状态互相可达，闭包相同，只需要计算一次。
+// Tarjan算法按照拓扑逆序产生分量（一个分量产生时，它能到达的其他分量都已经产生），因此每个分量产生时
+// 直接合并自身的状态与各后继分量的闭包即可，整个计算只遍历一次ε转移图。
+// 状态数不超过bitsetStateLimit时闭包保存为位集合（合并是按字或）；否则只保存分量之间的有向无环图，
+// 需要时再沿分量遍历得到闭包（闭包的总大小可能是O(状态数^2)的，比如很长的ε链）。
+// 闭包中是否包含终止状态总是预先计算好的
+// 表与计算过程中的临时数组都从resource分配
+// 非位集合模式下getClosure复用表中的遍历数组，因此同一个表不能在多个线程中同时调用getClosure
+class EClosureTable
+{
+public:
+    static constexpr size_t DefaultBitsetStateLimit = 8192;
+
+    explicit EClosureTable(const NFA& nfa,
+                           size_t bitsetStateLimit = DefaultBitsetStateLimit,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : _stateCount(nfa.getStateCount()),
+          _bitset(nfa.getStateCount() <= bitsetStateLimit),
+          _words((nfa.getStateCount() + 63) / 64),
+          _componentOf(nfa.getStateCount(), Unvisited, resource),
+          _masks(resource),
+          _members(resource),
+          _memberOffsets(resource),
+          _successors(resource),
+          _successorOffsets(resource),
+          _componentAcceptFlags(resource),
+          _visitedEpochs(resource),
+          _pendingComponents(resource)
+    {
+        computeComponents(nfa, resource);
+        if (!_bitset)
+        {
+            _visitedEpochs.assign(getComponentCount(), 0);
+        }
+    }
+
+    size_t getStateCount() const
+    {
+        return _stateCount;
+    }
+
+    // ε转移图中强连通分量的个数
+    size_t getComponentCount() const
+    {
+        return _componentAcceptFlags.size();
+    }
+
+    // 闭包是否保存为位集合
+    bool isBitset() const
+    {
+        return _bitset;
+    }
+
+    // 位集合的字数
+    size_t getWords() const
+    {
+        return _words;
+    }
+
+    // 某状态ε闭包的位集合（共getWords()个字），只能在isBitset()时使用
+    const uint64_t* getMask(StateId state) const
+    {
+        return &_masks[_componentOf[state] * _words];
+    }
+
+    // 某状态的ε闭包（有序）
+    std::vector<StateId> getClosure(StateId state) const
+    {
+        std::vector<StateId> closure;
+        getClosure(state, closure);
+        return closure;
+    }
+
+    // 把某状态的ε闭包（有序）写入closure，可以复用closure的内存
+    template <typename Vector>
+    void getClosure(StateId state, Vector& closure) const
+    {
+        closure.clear();
+        if (!_bitset)
+        {
+            // 每次遍历使用新的标记，分量的标记等于当前标记表示已经访问过，不需要清空数组
+            if (++_visitEpoch == 0)
+            {
+                std::fill(_visitedEpochs.begin(), _visitedEpochs.end(), 0);
+                _visitEpoch = 1;
+            }
+            _pendingComponents.clear();
+            _pendingComponents.push_back(_componentOf[state]);
+            _visitedEpochs[_componentOf[state]] = _visitEpoch;
+            while (!_pendingComponents.empty())
+            {
+                const auto component = _pendingComponents.back();
+                _pendingComponents.pop_back();
+                closure.insert(closure.end(), _members.begin() + _memberOffsets[component], _members.begin() + _memberOffsets[component + 1]);
+                for (auto i = _successorOffsets[component]; i < _successorOffsets[component + 1]; i++)
+                {
+                    if (_visitedEpochs[_successors[i]] != _visitEpoch)
+                    {
+                        _visitedEpochs[_successors[i]] = _visitEpoch;
+                        _pendingComponents.push_back(_successors[i]);
+                    }
+                }
+            }
+            std::sort(closure.begin(), closure.end());
+            return;
+        }
+
+        const auto* mask = getMask(state);
+        for (size_t word = 0; word < _words; word++)
+        {
+            for (auto bits = mask[word]; bits != 0; bits &= bits - 1)
+            {
+                closure.push_back(static_cast<StateId>(word * 64 + std::countr_zero(bits)));
+            }
+        }
+    }
+
+    // 某状态的ε闭包中是否包含终止状态
+    bool containsAcceptState(StateId state) const
+    {
+        return _componentAcceptFlags[_componentOf[state]];
+    }
+
+private:
+    static constexpr uint32_t Unvisited = UINT32_MAX;
+
+    // 非递归的Tarjan算法，NFA可能有很多状态，递归可能导致栈溢出
+    void computeComponents(const NFA& nfa, std::pmr::memory_resource* resource)
+    {
+        std::pmr::vector<uint32_t> index(_stateCount, Unvisited, resource);
+        std::pmr::vector<uint32_t> lowLink(_stateCount, 0, resource);
+        std::pmr::vector<bool> onStack(_stateCount, false, resource);
+        std::pmr::vector<StateId> componentStack(resource);
+        // 模拟的调用栈：[状态、下一个要处理的转移在该状态转移列表中的下标]
+        std::pmr::vector<std::pair<StateId, uint32_t>> callStack(resource);
+        std::pmr::vector<StateId> members(resource);
+        uint32_t nextIndex = 0;
+
+        // 记录每个分量最后一次作为哪个分量的后继，用于后继分量去重
+        std::pmr::vector<uint32_t> lastComponent(_bitset ? 0 : _stateCount, Unvisited, resource);
+        if (!_bitset)
+        {
+            _memberOffsets.push_back(0);
+            _successorOffsets.push_back(0);
+        }
+
+        for (StateId root = 0; root < _stateCount; root++)
+        {
+            if (index[root] != Unvisited)
+            {
+                continue;
+            }
+            index[root] = lowLink[root] = nextIndex++;
+            componentStack.push_back(root);
+            onStack[root] = true;
+            callStack.push_back({root, 0});
+
+            while (!callStack.empty())
+            {
+                auto& [state, position] = callStack.back();
+                const auto transitions = nfa.getTransitions(state);
+                bool descended = false;
+                while (position < transitions.size())
+                {
+                    const auto& transition = transitions[position++];
+                    if (transition.input)
+                    {
+                        continue;
+                    }
+                    const auto next = transition.nextState;
+                    if (index[next] == Unvisited)
+                    {
+                        index[next] = lowLink[next] = nextIndex++;
+                        componentStack.push_back(next);
+                        onStack[next] = true;
+                        callStack.push_back({next, 0});
+                        descended = true;
+                        break;
+                    }
+                    if (onStack[next])
+                    {
+                        lowLink[state] = std::min(lowLink[state], index[next]);
+                    }
+                }
+                if (descended)
+                {
+                    continue;
+                }
+
+                const auto finished = state;
+                callStack.pop_back();
+                if (!callStack.empty())
+                {
+                    const auto parent = callStack.back().first;
+                    lowLink[parent] = std::min(lowLink[parent], lowLink[finished]);
+                }
+                if (lowLink[finished] == index[finished])
+                {
+                    // 弹出一个完整的分量
+                    members.clear();
+                    StateId member;
+                    do
+                    {
+                        member = componentStack.back();
+                        componentStack.pop_back();
+                        onStack[member] = false;
+                        members.push_back(member);
+                    } while (member != finished);
+                    addComponent(nfa, members, lastComponent);
+                }
+            }
+        }
+    }
+
+    // 计算一个新分量的闭包：自身的状态，加上ε转移到达的其他分量（都已经计算过）的闭包
+    // 不保存位集合时只记录分量的状态与后继分量
+    void addComponent(const NFA& nfa, const std::pmr::vector<StateId>& members, std::pmr::vector<uint32_t>& lastComponent)
+    {
+        FA_STATISTICS_ADD(epsilonClosures, 1);
+        const auto component = static_cast<uint32_t>(_componentAcceptFlags.size());
+        for (const auto member : members)
+        {
+            _componentOf[member] = component;
+        }
+
+        bool acceptable = false;
+        if (_bitset)
+        {
+            _masks.resize(_masks.size() + _words, 0);
+            auto* mask = &_masks[component * _words];
+            for (const auto member : members)
+            {
+                mask[member / 64] |= uint64_t(1) << (member % 64);
+                acceptable = acceptable || nfa.isAcceptState(member);
+                for (const auto& transition : nfa.getTransitions(member))
+                {
+                    const auto successor = _componentOf[transition.nextState];
+                    if (transition.input || successor == component)
+                    {
+                        continue;
+                    }
+                    const auto* successorMask = &_masks[successor * _words];
+                    for (size_t word = 0; word < _words; word++)
+                    {
+                        mask[word] |= successorMask[word];
+                    }
+                    acceptable = acceptable || _componentAcceptFlags[successor];
+                }
+            }
+        }
+        else
+        {
+            for (const auto member : members)
+            {
+                _members.push_back(member);
+                acceptable = acceptable || nfa.isAcceptState(member);
+                for (const auto& transition : nfa.getTransitions(member))
+                {
+                    const auto successor = _componentOf[transition.nextState];
+                    if (transition.input || successor == component || lastComponent[successor] == component)
+                    {
+                        continue;
+                    }
+                    lastComponent[successor] = component;
+                    _successors.push_back(successor);
+                    acceptable = acceptable || _componentAcceptFlags[successor];
+                }
+            }
+            _memberOffsets.push_back(static_cast<uint32_t>(_members.size()));
+            _successorOffsets.push_back(static_cast<uint32_t>(_successors.size()));
+        }
+        _componentAcceptFlags.push_back(acceptable);
+    }
+
+private:
+    size_t _stateCount;
+    bool _bitset;
+    size_t _words;
+    // 每个状态所属的分量
+    std::pmr::vector<uint32_t> _componentOf;
+    // 位集合模式下每个分量的闭包，下标为 分量 * _words + 字
+    std::pmr::vector<uint64_t> _masks;
+    // 否则记录每个分量的状态以及后继分量，_memberOffsets[c]、_successorOffsets[c]为分量c的起始位置
+    std::pmr::vector<StateId> _members;
+    std::pmr::vector<uint32_t> _memberOffsets;
+    std::pmr::vector<uint32_t> _successors;
+    std::pmr::vector<uint32_t> _successorOffsets;
+    // 每个分量的闭包中是否包含终止状态
+    std::pmr::vector<bool> _componentAcceptFlags;
+    // 非位集合模式下getClosure遍历分量时使用：每个分量最后一次被访问时的标记，以及待访问的分量
+    mutable std::pmr::vector<uint32_t> _visitedEpochs;
+    mutable uint32_t _visitEpoch = 0;
+    mutable std::pmr::vector<uint32_t> _pendingComponents;
+};
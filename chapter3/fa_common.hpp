@@ -1,14 +1,24 @@
 ﻿#pragma once
 
+#include <cstdint>
+#include <limits>
 #include <list>
+#include <optional>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+// 状态的展示名称，仅用于手工定义状态机以及生成graphviz
 using State = std::string;
+// 状态机内部使用的状态编号，编号是稠密的（从0开始连续分配）
+using StateId = std::uint32_t;
 using InputType = char;
 
+// 无效的状态编号，用于表示“不存在的转移”
+constexpr StateId InvalidStateId = std::numeric_limits<StateId>::max();
+
 static std::vector<InputType> convertStringToInputs(const std::string& str)
 {
     std::vector<InputType> inputs;
@@ -19,25 +29,125 @@ static std::vector<InputType> convertStringToInputs(const std::string& str)
     return inputs;
 }
 
-static std::string convertCombinationStateToString(const std::set<State>& stateSet)
+// 状态驻留表
+// 将状态名称映射为稠密的整数编号，并保留编号到名称的反查表，状态机内部的计算只使用编号
+class StateTable
+{
+public:
+    StateId intern(const State& state)
+    {
+        if (const auto it = _ids.find(state); it != _ids.end())
+        {
+            return it->second;
+        }
+        const auto id = static_cast<StateId>(_names.size());
+        _ids.emplace(state, id);
+        _names.push_back(state);
+        return id;
+    }
+
+    std::optional<StateId> find(const State& state) const
+    {
+        if (const auto it = _ids.find(state); it != _ids.end())
+        {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    size_t size() const
+    {
+        return _names.size();
+    }
+
+    const std::vector<State>& getNames() const
+    {
+        return _names;
+    }
+
+    std::vector<State> releaseNames()
+    {
+        _ids.clear();
+        return std::move(_names);
+    }
+
+private:
+    std::unordered_map<State, StateId> _ids;
+    std::vector<State> _names;
+};
+
+// 获取状态的展示名称，若没有名称表（比如由运算或转换生成的状态机）则使用编号作为名称
+static State getStateDisplayName(const std::vector<State>& stateNames, StateId state)
 {
-    std::string str;
-    // 必须依靠稳定顺序
-    for (const auto& s : stateSet)
+    if (state < stateNames.size())
     {
-        str += s;
+        return stateNames[state];
     }
-    return str;
+    return std::to_string(state);
 }
 
-// 将一个状态组合转换为一个字符串，通常，这个字符串作为构造新的状态机中的新状态
-static std::string convertCombinationStateToString(const std::vector<State>& stateSet)
+// 稀疏状态集合
+// 使用dense/sparse两个数组实现，插入、查询、清空都是O(1)，遍历的顺序为插入顺序，且不会在使用过程中分配内存
+class SparseStateSet
 {
-    std::string str;
-    // 必须依靠稳定顺序
-    for (const auto& s : stateSet)
+public:
+    explicit SparseStateSet(size_t capacity)
+        : _dense(capacity),
+          _sparse(capacity),
+          _size(0)
     {
-        str += s;
     }
-    return str;
-}
\ No newline at end of file
+
+    bool contains(StateId state) const
+    {
+        const auto index = _sparse[state];
+        return index < _size && _dense[index] == state;
+    }
+
+    // 插入状态，若状态已经存在则返回false
+    bool insert(StateId state)
+    {
+        if (contains(state))
+        {
+            return false;
+        }
+        _sparse[state] = static_cast<StateId>(_size);
+        _dense[_size++] = state;
+        return true;
+    }
+
+    void clear()
+    {
+        _size = 0;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    size_t capacity() const
+    {
+        return _dense.size();
+    }
+
+    auto begin() const
+    {
+        return _dense.begin();
+    }
+
+    auto end() const
+    {
+        return _dense.begin() + _size;
+    }
+
+private:
+    std::vector<StateId> _dense;
+    std::vector<StateId> _sparse;
+    size_t _size;
+};
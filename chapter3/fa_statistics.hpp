@@ -0,0 +1,130 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// 构造与匹配过程的统计（可选）
+// 只有定义了FA_STATISTICS宏时才会统计，否则FA_STATISTICS_ADD展开为空语句，参数也不会被求值，没有任何开销
+// 统计按线程收集：在当前线程上创建一个Collector，它的生存期内当前线程中的构造与匹配都会累加到它上面
+// 可以提供一个跟踪回调，每次计数增加时调用，用于找出导致构造或匹配变慢的模式
+// 注意：FA_STATISTICS会改变其他头文件中内联函数（比如CompiledDFA::StreamMatcher::feed、LazyDFA的匹配）的函数体，
+// 整个程序必须一致地定义或者不定义它，应当作为整个目标的编译选项（CMake中的target_compile_definitions），
+// 而不是在某个源文件中include之前#define，否则不同的编译单元会得到不同的函数体，违反ODR，链接器可能任意选择其中一个。
+// MSVC会在链接时检查各编译单元是否一致
+namespace fa_statistics {
+
+struct Statistics
+{
+    // 子集构造（以及惰性DFA）创建的DFA状态数
+    uint64_t subsetStates = 0;
+    // ε闭包的计算次数
+    uint64_t epsilonClosures = 0;
+    // nfa_operator的连接、并、重复运算中复制的状态转移数
+    uint64_t ruleCopies = 0;
+    // 最小化过程中处理的划分者个数
+    uint64_t minimizationRounds = 0;
+    // 匹配时处理的输入字节数
+    uint64_t bytesProcessed = 0;
+    // 匹配因进入死状态而提前结束的次数
+    uint64_t deadStateExits = 0;
+    // 惰性DFA在缓存中没有找到转移、需要计算的次数
+    uint64_t cacheMisses = 0;
+
+    std::string toString() const
+    {
+        return std::format("subsetStates={} epsilonClosures={} ruleCopies={} minimizationRounds={} bytesProcessed={} deadStateExits={} cacheMisses={}",
+                           subsetStates,
+                           epsilonClosures,
+                           ruleCopies,
+                           minimizationRounds,
+                           bytesProcessed,
+                           deadStateExits,
+                           cacheMisses);
+    }
+};
+
+// 跟踪回调，参数为[计数器名称、增加的值]
+using TraceCallback = std::function<void(std::string_view counter, uint64_t value)>;
+
+// 统计收集器，构造时成为当前线程的收集器，析构时恢复之前的收集器，因此可以嵌套使用
+class Collector
+{
+public:
+    explicit Collector(TraceCallback trace = nullptr)
+        : _trace(std::move(trace)),
+          _previous(current())
+    {
+        current() = this;
+    }
+
+    ~Collector()
+    {
+        current() = _previous;
+    }
+
+    Collector(const Collector&) = delete;
+    Collector& operator=(const Collector&) = delete;
+
+    const Statistics& getStatistics() const
+    {
+        return _statistics;
+    }
+
+    void reset()
+    {
+        _statistics = {};
+    }
+
+    // 当前线程的收集器，没有时为nullptr
+    static Collector*& current()
+    {
+        static thread_local Collector* collector = nullptr;
+        return collector;
+    }
+
+    static void add(uint64_t Statistics::*counter, std::string_view name, uint64_t value)
+    {
+        if (auto* collector = current())
+        {
+            collector->_statistics.*counter += value;
+            if (collector->_trace)
+            {
+                collector->_trace(name, value);
+            }
+        }
+    }
+
+private:
+    Statistics _statistics;
+    TraceCallback _trace;
+    Collector* _previous;
+};
+
+// 是否编译了统计
+constexpr bool isEnabled()
+{
+#ifdef FA_STATISTICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+}// namespace fa_statistics
+
+#ifdef _MSC_VER
+#ifdef FA_STATISTICS
+#pragma detect_mismatch("FA_STATISTICS", "1")
+#else
+#pragma detect_mismatch("FA_STATISTICS", "0")
+#endif
+#endif
+
+#ifdef FA_STATISTICS
+#define FA_STATISTICS_ADD(counter, value) fa_statistics::Collector::add(&fa_statistics::Statistics::counter, #counter, (value))
+#else
+#define FA_STATISTICS_ADD(counter, value) static_cast<void>(0)
+#endif
@@ -0,0 +1,27 @@
+﻿#include <fstream>
+#include <iostream>
+
+#include "dfa2cpp.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+
+// 为测试生成匹配函数：generate_dfa2cpp_matchers 输出文件 函数名 模式 [函数名 模式 ...]
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc % 2 != 0)
+    {
+        std::cerr << "usage: " << argv[0] << " output [function pattern]..." << std::endl;
+        return 1;
+    }
+
+    std::string code = "#pragma once\n\n";
+    for (int i = 2; i < argc; i += 2)
+    {
+        code += dfa2cpp::dfa2cpp(nfa2dfa::convertNFA2DFA(regex_generate::compile(argv[i + 1])).minimize(), argv[i]);
+        code += "\n";
+    }
+
+    std::ofstream output(argv[1], std::ios::binary);
+    output << code;
+    return output ? 0 : 1;
+}
@@ -0,0 +1,342 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "byte_classes.hpp"
+#include "fa_statistics.hpp"
+#include "nfa.hpp"
+#include "state_set_table.hpp"
+
+// 惰性（按需构造的）DFA
+// 不预先进行子集构造，而是在匹配时第一次到达某个[DFA状态、字节类]组合时才计算转移，并缓存在状态转移表中
+// 缓存的内存有上限：超过上限时清空缓存后继续构造；如果清空过于频繁（平均每个缓存状态处理的字节数过少），
+// 说明缓存已经起不到作用，则对剩余的输入退化为NFA状态集合模拟
+// 匹配会修改缓存，因此同一个LazyDFA对象不能在多个线程中同时使用
+class LazyDFA
+{
+public:
+    static constexpr size_t DefaultCacheBytesLimit = 2 * 1024 * 1024;
+    // 清空缓存时，如果平均每个缓存状态处理的字节数少于此值，则退化为NFA模拟
+    static constexpr size_t MinBytesPerState = 10;
+
+    explicit LazyDFA(const NFA& nfa, size_t cacheBytesLimit = DefaultCacheBytesLimit)
+        : _nfaStateCount(nfa.getStateCount()),
+          _byteClasses(nfa.getByteClasses()),
+          _rowWidth(_byteClasses.getClassCount()),
+          _cacheBytesLimit(cacheBytesLimit),
+          _scratchStateSet(nfa.getStateCount()),
+          _scratchNextStateSet(nfa.getStateCount())
+    {
+        // 按开始状态分别记录非空转移[字节类、下一个状态]与ε转移
+        _inputOffsets.assign(_nfaStateCount + 1, 0);
+        _epsilonOffsets.assign(_nfaStateCount + 1, 0);
+        for (StateId state = 0; state < _nfaStateCount; state++)
+        {
+            for (const auto& transition : nfa.getTransitions(state))
+            {
+                if (transition.input)
+                {
+                    // 一条转移覆盖的每个字节类各记录一次
+                    for (const auto input : _byteClasses.getClasses(transition.input->getBytes()))
+                    {
+                        _inputTransitions.push_back({input, transition.nextState});
+                    }
+                }
+                else
+                {
+                    _epsilonTransitions.push_back(transition.nextState);
+                }
+            }
+            _inputOffsets[state + 1] = static_cast<uint32_t>(_inputTransitions.size());
+            _epsilonOffsets[state + 1] = static_cast<uint32_t>(_epsilonTransitions.size());
+        }
+
+        _nfaAcceptStateFlags.assign(_nfaStateCount, false);
+        for (const auto state : nfa.getAcceptStateList())
+        {
+            _nfaAcceptStateFlags[state] = true;
+        }
+
+        _scratchStateSet.clear();
+        addEClosure(_scratchStateSet, nfa.getInitialState());
+        _initialStateSet.assign(_scratchStateSet.begin(), _scratchStateSet.end());
+        std::sort(_initialStateSet.begin(), _initialStateSet.end());
+
+        clearCache();
+    }
+
+    bool accept(std::string_view inputs)
+    {
+        if (_initialState == UnknownState)
+        {
+            _initialState = addState(_initialStateSet);
+        }
+
+        _clearPosition = 0;
+        size_t position = 0;
+        const auto accepted = acceptByDFA(inputs, position);
+        // 累计自上次清空缓存以来以DFA方式处理的字节数，用于判断缓存是否还有效
+        _bytesSinceClear += position - _clearPosition;
+        return accepted;
+    }
+
+    bool accept(const std::vector<InputType>& inputs)
+    {
+        return accept(std::string_view(inputs.data(), inputs.size()));
+    }
+
+    // 当前缓存的DFA状态个数（包括死状态）
+    size_t getCachedStateCount() const
+    {
+        return _stateSets.size();
+    }
+
+    // 当前缓存占用的字节数（估算值）
+    size_t getCacheBytes() const
+    {
+        return _cacheBytes;
+    }
+
+    // 缓存被清空的次数
+    size_t getCacheClearCount() const
+    {
+        return _cacheClearCount;
+    }
+
+    // 退化为NFA模拟的次数
+    size_t getFallbackCount() const
+    {
+        return _fallbackCount;
+    }
+
+private:
+    // 尚未计算的转移
+    static constexpr uint32_t UnknownState = UINT32_MAX;
+    // 需要退化为NFA模拟
+    static constexpr uint32_t FallbackState = UINT32_MAX - 1;
+    // 死状态，即空的NFA状态集合
+    static constexpr uint32_t DeadState = 0;
+
+    struct InputTransition
+    {
+        ByteClassId input;
+        StateId nextState;
+    };
+
+    // 以DFA的方式进行匹配，position返回以DFA方式处理到的位置
+    bool acceptByDFA(std::string_view inputs, size_t& position)
+    {
+        auto currentState = _initialState;
+        for (; position < inputs.size(); position++)
+        {
+            const auto input = _byteClasses.getClass(inputs[position]);
+            auto nextState = _table[currentState * _rowWidth + input];
+            if (nextState == UnknownState)
+            {
+                nextState = computeNextState(currentState, input, position);
+                if (nextState == FallbackState)
+                {
+                    _fallbackCount++;
+                    FA_STATISTICS_ADD(bytesProcessed, position + 1);
+                    return acceptByNFA(inputs.substr(position + 1));
+                }
+            }
+            currentState = nextState;
+            if (currentState == DeadState)
+            {
+                FA_STATISTICS_ADD(bytesProcessed, position + 1);
+                FA_STATISTICS_ADD(deadStateExits, 1);
+                return false;
+            }
+        }
+        FA_STATISTICS_ADD(bytesProcessed, inputs.size());
+        return _acceptStateFlags[currentState];
+    }
+
+    // 计算缓存中某状态接受某字节类之后的状态，必要时清空缓存或者要求退化为NFA模拟
+    uint32_t computeNextState(uint32_t state, ByteClassId input, size_t position)
+    {
+        FA_STATISTICS_ADD(cacheMisses, 1);
+        stepStateSet(_stateSets.getStateSet(state), input);
+        // 排序到复用的数组中，缓存未命中时不需要分配内存
+        auto& nextStateSet = _sortedNextStateSet;
+        nextStateSet.assign(_scratchNextStateSet.begin(), _scratchNextStateSet.end());
+        std::sort(nextStateSet.begin(), nextStateSet.end());
+
+        if (const auto existing = _stateSets.find(nextStateSet); existing != InvalidStateId)
+        {
+            _table[state * _rowWidth + input] = existing;
+            return existing;
+        }
+
+        if (_cacheBytes + getStateBytes(nextStateSet) > _cacheBytesLimit)
+        {
+            const auto bytesSinceClear = _bytesSinceClear + position - _clearPosition;
+            if (bytesSinceClear < MinBytesPerState * _stateSets.size())
+            {
+                _fallbackStateSet = nextStateSet;
+                return FallbackState;
+            }
+            // 清空之后当前状态的编号不再有效，因此不需要填写当前状态的转移
+            clearCache();
+            _clearPosition = position;
+            _bytesSinceClear = 0;
+            return addState(nextStateSet);
+        }
+
+        const auto nextState = addState(nextStateSet);
+        _table[state * _rowWidth + input] = nextState;
+        return nextState;
+    }
+
+    // 计算NFA状态集合在接受某字节类之后到达的状态集合（包括ε闭包），结果保存在_scratchNextStateSet中
+    void stepStateSet(std::span<const StateId> stateSet, ByteClassId input)
+    {
+        _scratchNextStateSet.clear();
+        for (const auto state : stateSet)
+        {
+            for (auto i = _inputOffsets[state]; i < _inputOffsets[state + 1]; i++)
+            {
+                if (_inputTransitions[i].input == input)
+                {
+                    addEClosure(_scratchNextStateSet, _inputTransitions[i].nextState);
+                }
+            }
+        }
+    }
+
+    void addEClosure(SparseStateSet& stateSet, StateId startState)
+    {
+        if (!stateSet.insert(startState))
+        {
+            return;
+        }
+        FA_STATISTICS_ADD(epsilonClosures, 1);
+        _pendingState.push_back(startState);
+        while (!_pendingState.empty())
+        {
+            const auto state = _pendingState.back();
+            _pendingState.pop_back();
+            for (auto i = _epsilonOffsets[state]; i < _epsilonOffsets[state + 1]; i++)
+            {
+                if (stateSet.insert(_epsilonTransitions[i]))
+                {
+                    _pendingState.push_back(_epsilonTransitions[i]);
+                }
+            }
+        }
+    }
+
+    // 对剩余输入进行NFA状态集合模拟，起始集合为_fallbackStateSet
+    bool acceptByNFA(std::string_view inputs)
+    {
+        auto* currentStateSet = &_scratchStateSet;
+        auto* nextStateSet = &_scratchNextStateSet;
+        currentStateSet->clear();
+        for (const auto state : _fallbackStateSet)
+        {
+            currentStateSet->insert(state);
+        }
+
+        for (size_t position = 0; position < inputs.size(); position++)
+        {
+            const auto input = _byteClasses.getClass(inputs[position]);
+            nextStateSet->clear();
+            for (const auto state : *currentStateSet)
+            {
+                for (auto i = _inputOffsets[state]; i < _inputOffsets[state + 1]; i++)
+                {
+                    if (_inputTransitions[i].input == input)
+                    {
+                        addEClosure(*nextStateSet, _inputTransitions[i].nextState);
+                    }
+                }
+            }
+            std::swap(currentStateSet, nextStateSet);
+            if (currentStateSet->empty())
+            {
+                FA_STATISTICS_ADD(bytesProcessed, position + 1);
+                FA_STATISTICS_ADD(deadStateExits, 1);
+                return false;
+            }
+        }
+        FA_STATISTICS_ADD(bytesProcessed, inputs.size());
+
+        return std::any_of(currentStateSet->begin(), currentStateSet->end(), [this](StateId state) {
+            return _nfaAcceptStateFlags[state];
+        });
+    }
+
+    uint32_t addState(std::span<const StateId> stateSet)
+    {
+        FA_STATISTICS_ADD(subsetStates, 1);
+        const auto state = _stateSets.intern(stateSet).first;
+        _table.resize(_table.size() + _rowWidth, UnknownState);
+        _acceptStateFlags.push_back(std::any_of(stateSet.begin(), stateSet.end(), [this](StateId nfaState) {
+            return _nfaAcceptStateFlags[nfaState];
+        }));
+        _cacheBytes += getStateBytes(stateSet);
+        return state;
+    }
+
+    // 估算一个缓存状态占用的字节数：状态转移表的一行、状态集合以及驻留表的开销
+    size_t getStateBytes(std::span<const StateId> stateSet) const
+    {
+        return _rowWidth * sizeof(uint32_t) + stateSet.size() * sizeof(StateId) + 64;
+    }
+
+    void clearCache()
+    {
+        if (!_stateSets.empty())
+        {
+            _cacheClearCount++;
+        }
+        _stateSets.clear();
+        _table.clear();
+        _acceptStateFlags.clear();
+        _cacheBytes = 0;
+        _initialState = UnknownState;
+
+        // 死状态的所有转移都指向自身
+        addState({});
+        std::fill(_table.begin(), _table.end(), DeadState);
+    }
+
+private:
+    size_t _nfaStateCount;
+    ByteClasses _byteClasses;
+    size_t _rowWidth;
+    size_t _cacheBytesLimit;
+
+    std::vector<InputTransition> _inputTransitions;
+    std::vector<uint32_t> _inputOffsets;
+    std::vector<StateId> _epsilonTransitions;
+    std::vector<uint32_t> _epsilonOffsets;
+    std::vector<bool> _nfaAcceptStateFlags;
+    std::vector<StateId> _initialStateSet;
+
+    // 缓存：NFA状态集合与DFA状态的双向映射、状态转移表、可接受标记
+    StateSetTable _stateSets;
+    std::vector<uint32_t> _table;
+    std::vector<bool> _acceptStateFlags;
+    size_t _cacheBytes = 0;
+    uint32_t _initialState = UnknownState;
+
+    // 本次匹配中最后一次清空缓存的位置，以及此前累计的处理字节数
+    size_t _clearPosition = 0;
+    size_t _bytesSinceClear = 0;
+    size_t _cacheClearCount = 0;
+    size_t _fallbackCount = 0;
+
+    SparseStateSet _scratchStateSet;
+    SparseStateSet _scratchNextStateSet;
+    std::vector<StateId> _pendingState;
+    // computeNextState中排序后的下一个状态集合
+    std::vector<StateId> _sortedNextStateSet;
+    std::vector<StateId> _fallbackStateSet;
+};
@@ -0,0 +1,261 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "compiled_dfa.hpp"
+#include "eclosure.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+
+// 词法分析器的规则：正则表达式、匹配时产生的记号编号，以及优先级
+// 多条规则匹配同样长度的输入时，优先级高的规则胜出；优先级相同时先添加的规则胜出
+struct LexerRule
+{
+    std::string pattern;
+    int tokenId;
+    int priority;
+};
+
+// 记号，表示输入中的区间 [start, end) 被识别为tokenId
+struct Token
+{
+    int tokenId;
+    size_t start;
+    size_t end;
+
+    bool operator==(const Token&) const = default;
+};
+
+// 多模式词法分析器
+// 所有规则的NFA通过一个新的起始状态（ε转移到每条规则的起始状态）合并为一个NFA，子集构造之后得到一个DFA，
+// DFA的每个终止状态都标记为其包含的规则中胜出的那一条规则的记号
+// 分析时按照最长匹配原则：从当前位置开始一直转移到死状态为止，记录最后经过的终止状态，
+// 因此每个位置只需要运行一个DFA，与规则的数量无关
+// 越过最长匹配之后扫描过的输入会在下一个记号中重新扫描，对于 a 与 a*b 这类规则，单独调用nextToken切分整个输入是O(n^2)的。
+// tokenize使用Reps的记忆化（"Maximal-munch" tokenization in linear time）：记录越过最长匹配之后经过的[状态、位置]，
+// 从它们出发不会再到达终止状态，之后的扫描再次经过时立即停止，因此每个[状态、位置]至多扫描一次，整体是线性的
+class Lexer
+{
+public:
+    // 无法识别的字节产生的记号编号，每个无法识别的字节产生一个记号
+    static constexpr int ErrorToken = -1;
+
+    explicit Lexer(const std::vector<LexerRule>& rules)
+        : Lexer(buildAutomaton(rules))
+    {
+    }
+
+    // 编译后的DFA的状态个数（包括死状态）
+    size_t getStateCount() const
+    {
+        return _dfa.getStateCount();
+    }
+
+    // 从position开始按最长匹配识别一个记号，position必须小于输入的长度
+    // 没有任何规则能匹配非空的输入时，返回只包含一个字节的ErrorToken
+    Token nextToken(std::string_view inputs, size_t position) const
+    {
+        return scanToken(inputs, position, nullptr);
+    }
+
+    // 将输入切分为记号序列，时间与输入的长度成线性关系
+    std::vector<Token> tokenize(std::string_view inputs) const
+    {
+        std::vector<Token> tokens;
+        FailedPairs failed;
+        for (size_t position = 0; position < inputs.size();)
+        {
+            // 之前记录的位置都已经越过，不会再被查询
+            if (position >= failed.end)
+            {
+                failed.pairs.clear();
+            }
+            const auto token = scanToken(inputs, position, &failed);
+            tokens.push_back(token);
+            position = token.end;
+        }
+        return tokens;
+    }
+
+private:
+    static constexpr uint32_t NoRule = UINT32_MAX;
+    static constexpr int NoToken = INT32_MIN;
+
+    // 已知不会再到达终止状态的[状态、位置]（状态处于位置之前，即还没有读入该位置的字节），所有位置都小于end
+    struct FailedPairs
+    {
+        std::unordered_set<uint64_t> pairs;
+        size_t end = 0;
+    };
+
+    uint64_t getPairKey(uint32_t state, size_t position) const
+    {
+        return position * _dfa.getStateCount() + state / _dfa.getRowWidth();
+    }
+
+    // 从position开始按最长匹配识别一个记号，failed不为空时使用并更新记忆化的[状态、位置]
+    Token scanToken(std::string_view inputs, size_t position, FailedPairs* failed) const
+    {
+        const auto rowWidth = _dfa.getRowWidth();
+        Token token{ErrorToken, position, position + 1};
+        auto state = _dfa.getInitialState();
+        // 扫描停止的位置，此时还没有读入该位置的字节
+        auto current = position;
+        for (; current < inputs.size(); current++)
+        {
+            if (failed != nullptr && current < failed->end && failed->pairs.contains(getPairKey(state, current)))
+            {
+                break;
+            }
+            const auto nextState = _dfa.getNextState(state, inputs[current]);
+            if (nextState == CompiledDFA::DeadState)
+            {
+                break;
+            }
+            state = nextState;
+            if (const auto tokenId = _tokenOfState[state / rowWidth]; tokenId != NoToken)
+            {
+                token.tokenId = tokenId;
+                token.end = current + 1;
+            }
+        }
+
+        // 从最后一次到达终止状态之后经过的[状态、位置]都不会再到达终止状态，重新执行一遍记录下来
+        // 读入最长匹配之后的第一个字节就进入死状态时（最常见的情况，比如标识符后面的空格）没有需要记录的状态
+        const auto acceptPosition = token.tokenId == ErrorToken ? position : token.end;
+        if (failed != nullptr && current > acceptPosition)
+        {
+            state = _dfa.getInitialState();
+            for (auto replay = position;; replay++)
+            {
+                if (replay >= acceptPosition)
+                {
+                    failed->pairs.insert(getPairKey(state, replay));
+                }
+                if (replay == current)
+                {
+                    break;
+                }
+                state = _dfa.getNextState(state, inputs[replay]);
+            }
+            failed->end = std::max(failed->end, current + 1);
+        }
+        return token;
+    }
+
+    // 合并之后的DFA，以及编译后的每个状态所标记的记号
+    struct Automaton
+    {
+        DFA dfa;
+        std::vector<int> tokenOfState;
+    };
+
+    // 不同规则的接受汇点标记的记号可能不同，因此不能合并
+    explicit Lexer(Automaton automaton)
+        : _dfa(automaton.dfa, false),
+          _tokenOfState(std::move(automaton.tokenOfState))
+    {
+    }
+
+    static Automaton buildAutomaton(const std::vector<LexerRule>& rules)
+    {
+        // 状态0为新的起始状态，每条规则的NFA状态整体偏移
+        std::vector<NFATransition> transitions;
+        std::vector<StateId> acceptStates;
+        // 每个NFA终止状态所属的规则
+        std::vector<uint32_t> ruleOfState = {NoRule};
+        StateId stateCount = 1;
+        for (uint32_t rule = 0; rule < rules.size(); rule++)
+        {
+            const auto nfa = regex_generate::compile(rules[rule].pattern);
+            const auto offset = stateCount;
+            for (const auto& transition : nfa.getTransitions())
+            {
+                transitions.push_back({transition.startState + offset, transition.input, transition.nextState + offset});
+            }
+            transitions.push_back({0, std::nullopt, nfa.getInitialState() + offset});
+            ruleOfState.resize(offset + nfa.getStateCount(), NoRule);
+            for (const auto state : nfa.getAcceptStateList())
+            {
+                acceptStates.push_back(state + offset);
+                ruleOfState[state + offset] = rule;
+            }
+            stateCount += static_cast<StateId>(nfa.getStateCount());
+        }
+        const NFA nfa(0, stateCount, std::move(transitions), acceptStates);
+
+        // 每个NFA状态沿ε转移可以到达的终止状态中胜出的规则
+        const auto better = [&rules](uint32_t rule, uint32_t other) {
+            if (other == NoRule)
+            {
+                return rule;
+            }
+            if (rule == NoRule)
+            {
+                return other;
+            }
+            if (rules[rule].priority != rules[other].priority)
+            {
+                return rules[rule].priority > rules[other].priority ? rule : other;
+            }
+            return std::min(rule, other);
+        };
+        const EClosureTable closures(nfa);
+        std::vector<uint32_t> winningRuleOfState(stateCount, NoRule);
+        for (StateId state = 0; state < stateCount; state++)
+        {
+            for (const auto closureState : closures.getClosure(state))
+            {
+                winningRuleOfState[state] = better(winningRuleOfState[state], ruleOfState[closureState]);
+            }
+        }
+
+        std::vector<std::vector<StateId>> combinationStates;
+        auto dfa = nfa2dfa::convertNFA2DFA(nfa, combinationStates);
+
+        // 编译后的状态i+1对应DFA的状态i，状态0为死状态
+        std::vector<int> tokenOfState(dfa.getStateCount() + 1, NoToken);
+        for (StateId state = 0; state < dfa.getStateCount(); state++)
+        {
+            auto rule = NoRule;
+            for (const auto nfaState : combinationStates[state])
+            {
+                rule = better(rule, winningRuleOfState[nfaState]);
+            }
+            if (rule != NoRule)
+            {
+                tokenOfState[state + 1] = rules[rule].tokenId;
+            }
+        }
+
+        return {std::move(dfa), std::move(tokenOfState)};
+    }
+
+private:
+    CompiledDFA _dfa;
+    // 编译后的每个状态所标记的记号，非终止状态为NoToken
+    std::vector<int> _tokenOfState;
+};
+
+// 词法分析器的构造器，依次添加规则之后构造词法分析器
+class LexerBuilder
+{
+public:
+    void add(std::string pattern, int tokenId, int priority = 0)
+    {
+        _rules.push_back({std::move(pattern), tokenId, priority});
+    }
+
+    Lexer build() const
+    {
+        return Lexer(_rules);
+    }
+
+private:
+    std::vector<LexerRule> _rules;
+};
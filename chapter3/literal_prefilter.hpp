@@ -0,0 +1,122 @@
+﻿#pragma once
+
+#include <bit>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LITERAL_PREFILTER_SSE2 1
+#endif
+
+#include "dfa.hpp"
+
+// 提取DFA的所有匹配都必须以之开头的字面量前缀
+// 从起始状态开始，只要当前状态不是终止状态，且只有一个只包含单个字节的字节类的转移，这个字节就是前缀的一部分
+// DFA需要是最小化的（没有无法到达终止状态的状态），否则转移到死状态的转移也会被计算在内
+static std::string extractLiteralPrefix(const DFA& dfa)
+{
+    std::string prefix;
+    auto state = dfa.getInitialState();
+    // 前缀不会比状态数更长，以此防止在环上无限循环
+    while (prefix.size() < dfa.getStateCount() && !dfa.isAcceptState(state))
+    {
+        const auto transitions = dfa.getTransitions(state);
+        if (transitions.size() != 1)
+        {
+            break;
+        }
+        const auto bytes = dfa.getByteClasses().getBytes(transitions[0].input);
+        if (bytes.count() != 1)
+        {
+            break;
+        }
+        prefix.push_back(dfa.getByteClasses().getRepresentative(transitions[0].input));
+        state = transitions[0].nextState;
+    }
+    return prefix;
+}
+
+// 字面量预过滤器：在DFA运行之前快速找到字面量出现的位置，DFA只需要从这些候选位置开始匹配
+// 单个字节使用memchr（标准库中通常已经是向量化的实现）；
+// 多个字节在支持SSE2时每次比较16个位置的首字节与末字节，两者都相同的位置再用memcmp确认中间的字节
+class LiteralPrefilter
+{
+public:
+    explicit LiteralPrefilter(std::string literal = {})
+        : _literal(std::move(literal))
+    {
+    }
+
+    bool empty() const
+    {
+        return _literal.empty();
+    }
+
+    const std::string& getLiteral() const
+    {
+        return _literal;
+    }
+
+    // 查找from之后字面量第一次出现的位置，找不到时返回std::string_view::npos
+    size_t find(std::string_view inputs, size_t from = 0) const
+    {
+        const auto length = _literal.size();
+        if (from > inputs.size() || inputs.size() - from < length)
+        {
+            return std::string_view::npos;
+        }
+        if (length == 0)
+        {
+            return from;
+        }
+
+        const auto* data = inputs.data();
+        if (length == 1)
+        {
+            const auto* found = static_cast<const char*>(std::memchr(data + from, _literal[0], inputs.size() - from));
+            return found ? static_cast<size_t>(found - data) : std::string_view::npos;
+        }
+
+        // 候选位置的范围为 [from, last]
+        const auto last = inputs.size() - length;
+        auto position = from;
+#ifdef LITERAL_PREFILTER_SSE2
+        const auto firstBytes = _mm_set1_epi8(_literal.front());
+        const auto lastBytes = _mm_set1_epi8(_literal.back());
+        for (; position + 16 <= last + 1; position += 16)
+        {
+            const auto firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+            const auto lastBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position + length - 1));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBytes, firstBlock),
+                                                                              _mm_cmpeq_epi8(lastBytes, lastBlock))));
+            for (; mask != 0; mask &= mask - 1)
+            {
+                const auto candidate = position + std::countr_zero(mask);
+                if (std::memcmp(data + candidate + 1, _literal.data() + 1, length - 2) == 0)
+                {
+                    return candidate;
+                }
+            }
+        }
+#endif
+        for (; position <= last; position++)
+        {
+            const auto* found = static_cast<const char*>(std::memchr(data + position, _literal[0], last + 1 - position));
+            if (!found)
+            {
+                break;
+            }
+            position = static_cast<size_t>(found - data);
+            if (std::memcmp(data + position + 1, _literal.data() + 1, length - 1) == 0)
+            {
+                return position;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+private:
+    std::string _literal;
+};
@@ -0,0 +1,125 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 只读的内存映射文件，用于零复制地加载序列化的自动机（CompiledDFA::load）
+// 多个进程映射同一个文件时共享同一份页缓存
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path)
+    {
+#ifdef _WIN32
+        _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("can't open file " + path);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(_file, &size))
+        {
+            close();
+            throw std::runtime_error("can't get size of file " + path);
+        }
+        _size = static_cast<size_t>(size.QuadPart);
+        if (_size > 0)
+        {
+            _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            _data = _mapping ? MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!_data)
+            {
+                close();
+                throw std::runtime_error("can't map file " + path);
+            }
+        }
+#else
+        const auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("can't open file " + path);
+        }
+        struct stat status;
+        if (::fstat(fd, &status) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("can't get size of file " + path);
+        }
+        _size = static_cast<size_t>(status.st_size);
+        if (_size > 0)
+        {
+            _data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+            if (_data == MAP_FAILED)
+            {
+                _data = nullptr;
+                ::close(fd);
+                throw std::runtime_error("can't map file " + path);
+            }
+        }
+        // 映射建立之后即可关闭文件描述符
+        ::close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    std::span<const std::byte> getData() const
+    {
+        return {static_cast<const std::byte*>(_data), _size};
+    }
+
+private:
+    void close()
+    {
+#ifdef _WIN32
+        if (_data)
+        {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping)
+        {
+            CloseHandle(_mapping);
+        }
+        if (_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(_file);
+        }
+        _mapping = nullptr;
+        _file = INVALID_HANDLE_VALUE;
+#else
+        if (_data)
+        {
+            ::munmap(_data, _size);
+        }
+#endif
+        _data = nullptr;
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = nullptr;
+#endif
+    void* _data = nullptr;
+    size_t _size = 0;
+};
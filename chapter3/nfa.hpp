@@ -1,23 +1,27 @@
 ﻿#pragma once
 
+#include <algorithm>
 #include <list>
-#include <map>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "byte_classes.hpp"
 #include "fa_common.hpp"
+#include "fa_statistics.hpp"
 
 // 有限状态机（状态转移）规则
 // 定义某个状态下接收到某个输入时转移到哪个状态
-// 因为用于实现NFA，所以输入允许为空
+// 因为用于实现NFA，所以输入允许为空，输入也可以是一个字节区间集合（比如[a-z]），表示接受其中任意一个字节
+// 规则使用状态名称描述，构造NFA时会被驻留为整数编号
 class NFARule
 {
 public:
-    NFARule(State startState, std::optional<InputType> character, State nextState)
+    NFARule(State startState, std::optional<ByteRangeSet> character, State nextState)
         : _startState(startState),
           _input(character),
           _nextState(nextState)
@@ -29,7 +33,7 @@ public:
         return _startState;
     }
 
-    const std::optional<InputType>& input() const
+    const std::optional<ByteRangeSet>& input() const
     {
         return _input;
     }
@@ -42,14 +46,18 @@ public:
     // 判断某开始状态和输入是否匹配此规则，匹配则表示接受
     bool accept(State currentState, std::optional<InputType> input) const
     {
-        return _startState == currentState && _input == input;
+        if (_startState != currentState)
+        {
+            return false;
+        }
+        return input ? (_input && _input->contains(input.value())) : !_input;
     }
 
 private:
     // 开始状态
     const State _startState;
     // 接受的输入是什么，允许为空
-    const std::optional<InputType> _input;
+    const std::optional<ByteRangeSet> _input;
     // 下一个状态
     const State _nextState;
 };
@@ -96,104 +104,155 @@ private:
     const std::set<State> _acceptStateSet;
 };
 
+// 整数编号下的状态转移，输入为空表示ε转移，否则接受输入字节区间集合中的任意一个字节
+struct NFATransition
+{
+    StateId startState;
+    std::optional<ByteRangeSet> input;
+    StateId nextState;
+};
+
 class NFA
 {
 public:
+    // 使用状态名称定义NFA，名称会被驻留为整数编号，并作为展示名称保留
     NFA(State initialState, std::vector<NFARule> rules, NFAAcceptStates acceptStates)
+    {
+        StateTable stateTable;
+        _initialState = stateTable.intern(initialState);
+
+        std::vector<NFATransition> transitions;
+        transitions.reserve(rules.size());
+        for (const auto& rule : rules)
+        {
+            const auto startState = stateTable.intern(rule.startState());
+            const auto nextState = stateTable.intern(rule.nextState());
+            transitions.push_back({startState, rule.input(), nextState});
+        }
+
+        std::vector<StateId> acceptStateList;
+        for (const auto& state : acceptStates.getAcceptStateSet())
+        {
+            acceptStateList.push_back(stateTable.intern(state));
+        }
+
+        _stateCount = stateTable.size();
+        _stateNames = stateTable.releaseNames();
+        initialize(std::move(transitions), acceptStateList);
+    }
+
+    // 直接使用整数编号定义NFA，状态编号必须小于stateCount，stateNames为可选的展示名称表
+    NFA(StateId initialState,
+        size_t stateCount,
+        std::vector<NFATransition> transitions,
+        const std::vector<StateId>& acceptStates,
+        std::vector<State> stateNames = {})
         : _initialState(initialState),
-          _rules(std::move(rules)),
-          _acceptStates(std::move(acceptStates)),
-          _transformRelation(generateTransformRelation())
-    {}
+          _stateCount(stateCount),
+          _stateNames(std::move(stateNames))
+    {
+        initialize(std::move(transitions), acceptStates);
+    }
 
-    NFA(const NFA& right)
-        : _initialState(right._initialState),
-          _rules(right._rules),
-          _acceptStates(right._acceptStates),
-          _transformRelation(generateTransformRelation())
+    StateId getInitialState() const
     {
+        return _initialState;
     }
 
-    NFA(NFA&& rvalue)
-        : _initialState(std::move(rvalue._initialState)),
-          _rules(std::move(rvalue._rules)),
-          _acceptStates(std::move(rvalue._acceptStates)),
-          _transformRelation(generateTransformRelation())
+    size_t getStateCount() const
     {
+        return _stateCount;
     }
 
-    const auto& getInitialState() const
+    bool isAcceptState(StateId state) const
     {
-        return _initialState;
+        return _acceptStateFlags[state];
     }
 
-    const NFAAcceptStates& getAcceptStates() const
+    bool isAcceptState(std::span<const StateId> stateSet) const
     {
-        return _acceptStates;
+        for (const auto state : stateSet)
+        {
+            if (isAcceptState(state))
+            {
+                return true;
+            }
+        }
+        return false;
     }
 
-    const auto& getRules() const
+    const std::vector<StateId>& getAcceptStateList() const
     {
-        return _rules;
+        return _acceptStateList;
     }
 
-    bool accept(const std::vector<InputType>& inputs) const
+    // 获取全部状态转移，按照开始状态排序
+    const std::vector<NFATransition>& getTransitions() const
     {
-        // 待处理列表，每一个元素为：[当前所属状态、待处理字符在输入中的索引]
-        std::vector<std::tuple<State, int>> pendingTaskList;
-        // 已处理的任务 [状态、输入索引]
-        std::set<std::tuple<State, int>> visitedTask;
-        // 从 [起始状态、0索引] 开始进行迭代处理
-        pendingTaskList.push_back({_initialState, 0});
+        return _transitions;
+    }
 
-        const auto inputSize = inputs.size();
+    // 获取从某状态开始的状态转移
+    std::span<const NFATransition> getTransitions(StateId state) const
+    {
+        return std::span<const NFATransition>(_transitions).subspan(
+                _transitionOffsets[state], _transitionOffsets[state + 1] - _transitionOffsets[state]);
+    }
 
-        while (!pendingTaskList.empty())
-        {
-            const auto currentTask = pendingTaskList.back();
-            pendingTaskList.pop_back();
-            visitedTask.insert(currentTask);
+    const std::vector<State>& getStateNames() const
+    {
+        return _stateNames;
+    }
 
-            const auto& [currentState, currentInputIndex] = currentTask;
+    State getStateName(StateId state) const
+    {
+        return getStateDisplayName(_stateNames, state);
+    }
 
-            // 如果当前任务的输入索引处于输入的末尾、且当前任务的状态是终结状态，则返回接受
-            if (currentInputIndex == inputSize && _acceptStates.accept(currentState))
-            {
-                return true;
-            }
+    // 判断从初始状态开始，此FA是否接受输入序列
+    // 使用广度优先的状态集合模拟：同时维护当前可能处于的所有状态，每处理一个输入就整体转移一次
+    // 内存为O(状态数)，且只在开始时分配一次
+    bool accept(const std::vector<InputType>& inputs) const
+    {
+        SparseStateSet currentStateSet(_stateCount);
+        SparseStateSet nextStateSet(_stateCount);
+        std::vector<StateId> pendingState;
+        pendingState.reserve(_stateCount);
 
-            const auto it = _transformRelation.find(currentState);
-            if (it == _transformRelation.end())
-            {
-                continue;
-            }
+        addEClosure(currentStateSet, _initialState, pendingState);
 
-            for (const auto& [input, nextStateSet] : it->second)
+        for (size_t position = 0; position < inputs.size(); position++)
+        {
+            nextStateSet.clear();
+            for (const auto state : currentStateSet)
             {
-                std::optional<int> nextInputIndex;
-                if (input && currentInputIndex < inputSize && input.value() == inputs[currentInputIndex])
+                for (const auto& transition : getTransitions(state))
                 {
-                    nextInputIndex = currentInputIndex + 1;
-                }
-                else if (!input)
-                {
-                    nextInputIndex = currentInputIndex;
-                }
-                else
-                {
-                    continue;
-                }
-
-                for (const auto& state : nextStateSet)
-                {
-                    if (!visitedTask.contains({state, nextInputIndex.value()}))
+                    if (transition.input && transition.input->contains(inputs[position]))
                     {
-                        pendingTaskList.push_back({state, nextInputIndex.value()});
+                        addEClosure(nextStateSet, transition.nextState, pendingState);
                     }
                 }
             }
+            std::swap(currentStateSet, nextStateSet);
+
+            if (currentStateSet.empty())
+            {
+                FA_STATISTICS_ADD(bytesProcessed, position + 1);
+                FA_STATISTICS_ADD(deadStateExits, 1);
+                return false;
+            }
         }
+        FA_STATISTICS_ADD(bytesProcessed, inputs.size());
 
+        // 处理完输入序列之后，判断当前状态集合中是否存在终止状态
+        for (const auto state : currentStateSet)
+        {
+            if (isAcceptState(state))
+            {
+                return true;
+            }
+        }
         return false;
     }
 
@@ -201,157 +260,135 @@ public:
     {
         std::vector<InputType> inputList;
         std::set<InputType> inputSet;
-        for (const auto& rule : _rules)
+        for (const auto& transition : _transitions)
         {
-            if (!rule.input())
+            if (!transition.input)
             {
                 continue;
             }
-            else if (const auto inputValue = rule.input().value();
-                     !inputSet.contains(inputValue))
+            for (const auto& [first, last] : transition.input->getRanges())
             {
-                inputSet.insert(inputValue);
-                inputList.push_back(inputValue);
+                for (auto byte = static_cast<size_t>(first); byte <= last; byte++)
+                {
+                    if (const auto inputValue = static_cast<InputType>(byte);
+                        !inputSet.contains(inputValue))
+                    {
+                        inputSet.insert(inputValue);
+                        inputList.push_back(inputValue);
+                    }
+                }
             }
         }
         return inputList;
     }
 
-    std::set<State> getStateSet() const
+    // 根据状态转移中出现的输入计算字节等价类
+    ByteClasses getByteClasses() const
     {
-        std::set<State> stateSet;
-        for (const auto& rule : _rules)
+        ByteClassBuilder builder;
+        for (const auto& transition : _transitions)
         {
-            stateSet.insert(rule.startState());
-            stateSet.insert(rule.nextState());
-        }
-        return stateSet;
-    }
-
-    // 获取非确定性状态转移表
-    const auto& getTransformRelation() const
-    {
-        return _transformRelation;
-    }
-
-    // 获取确定性状态转移表
-    // 外层map的key作为起始状态，其value表示此状态下接受的非空输入所能达到的状态集合
-    std::map<State, std::map<InputType, std::set<State>>> getDeterminationTransformRelation() const
-    {
-        std::map<State, std::map<InputType, std::set<State>>> transformMap;
-
-        const auto stateSet = getStateSet();
-        for (const auto& state : stateSet)
-        {
-            transformMap[state] = getDeterminationTransformUnderState(state);
+            if (transition.input)
+            {
+                builder.add(transition.input->getBytes());
+            }
         }
-        return transformMap;
+        return builder.build();
     }
 
-    // 计算以某状态开始，以空作为输入所能达到的状态集
-    std::set<State> getEClosure(State startState) const
+    // 计算以某状态开始，以空作为输入所能达到的状态集（有序）
+    std::vector<StateId> getEClosure(StateId startState) const
     {
-        std::set<State> eclosure;
+        FA_STATISTICS_ADD(epsilonClosures, 1);
+        std::vector<StateId> eclosure;
 
-        std::vector<State> pendingState;
-        std::set<State> visitedState;
+        std::vector<StateId> pendingState;
+        std::vector<bool> visitedState(_stateCount, false);
         pendingState.push_back(startState);
+        visitedState[startState] = true;
 
         while (!pendingState.empty())
         {
-            auto state = pendingState.back();
+            const auto state = pendingState.back();
             pendingState.pop_back();
+            eclosure.push_back(state);
 
-            eclosure.insert(state);
-            visitedState.insert(state);
-
-            const auto it = _transformRelation.find(state);
-            if (it == _transformRelation.end())
-            {
-                continue;
-            }
-            for (const auto& [input, nextState] : it->second)
+            for (const auto& transition : getTransitions(state))
             {
-                if (input)
+                if (transition.input || visitedState[transition.nextState])
                 {
                     continue;
                 }
-                for (const auto& state : nextState)
-                {
-                    if (visitedState.contains(state))
-                    {
-                        continue;
-                    }
-                    pendingState.push_back(state);
-                }
+                visitedState[transition.nextState] = true;
+                pendingState.push_back(transition.nextState);
             }
         }
 
+        std::sort(eclosure.begin(), eclosure.end());
         return eclosure;
     }
 
 private:
-    // 获取某状态开始的确定性状态转移表
-    std::map<InputType, std::set<State>> getDeterminationTransformUnderState(State startState) const
+    // 将某状态及其ε闭包加入状态集合，pendingState为复用的待处理栈
+    void addEClosure(SparseStateSet& stateSet, StateId startState, std::vector<StateId>& pendingState) const
     {
-        std::map<InputType, std::set<State>> result;
-
-        std::set<State> visitedState;
-        std::vector<State> pendingState;
+        if (!stateSet.insert(startState))
+        {
+            return;
+        }
+        FA_STATISTICS_ADD(epsilonClosures, 1);
         pendingState.push_back(startState);
         while (!pendingState.empty())
         {
-            auto currentState = pendingState.back();
+            const auto state = pendingState.back();
             pendingState.pop_back();
-            visitedState.insert(currentState);
-            const auto it = _transformRelation.find(currentState);
-            if (it == _transformRelation.end())
+            for (const auto& transition : getTransitions(state))
             {
-                continue;
-            }
-
-            for (const auto& [input, nextState] : it->second)
-            {
-                if (input)
-                {
-                    const auto& value = input.value();
-                    for (const auto& state : nextState)
-                    {
-                        result[value].insert(state);
-                    }
-                }
-                else
+                if (!transition.input && stateSet.insert(transition.nextState))
                 {
-                    for (const auto& state : nextState)
-                    {
-                        if (!visitedState.contains(state))
-                        {
-                            visitedState.insert(state);
-                            pendingState.push_back(state);
-                        }
-                    }
+                    pendingState.push_back(transition.nextState);
                 }
             }
         }
-
-        return result;
     }
 
-    // 构造非确定性状态转移表
-    std::map<State, std::map<std::optional<InputType>, std::set<State>>> generateTransformRelation() const
+    // 构造非确定性状态转移表：按开始状态对转移排序，并记录每个状态的转移区间
+    void initialize(std::vector<NFATransition> transitions, const std::vector<StateId>& acceptStates)
     {
-        std::map<State, std::map<std::optional<InputType>, std::set<State>>> transformMap;
-        for (const auto& rule : _rules)
+        std::stable_sort(transitions.begin(), transitions.end(), [](const auto& a, const auto& b) {
+            return a.startState < b.startState;
+        });
+        _transitions = std::move(transitions);
+
+        _transitionOffsets.assign(_stateCount + 1, 0);
+        for (const auto& transition : _transitions)
         {
-            transformMap[rule.startState()][rule.input()].insert(rule.nextState());
+            _transitionOffsets[transition.startState + 1]++;
+        }
+        for (size_t i = 0; i < _stateCount; i++)
+        {
+            _transitionOffsets[i + 1] += _transitionOffsets[i];
+        }
+
+        _acceptStateFlags.assign(_stateCount, false);
+        for (const auto state : acceptStates)
+        {
+            if (!_acceptStateFlags[state])
+            {
+                _acceptStateFlags[state] = true;
+                _acceptStateList.push_back(state);
+            }
         }
-        return transformMap;
     }
 
 
 private:
-    const State _initialState;
-    const std::vector<NFARule> _rules;
-    const NFAAcceptStates _acceptStates;
-    const std::map<State, std::map<std::optional<InputType>, std::set<State>>> _transformRelation;
+    StateId _initialState;
+    size_t _stateCount;
+    std::vector<NFATransition> _transitions;
+    // 状态state的转移位于 _transitions[_transitionOffsets[state], _transitionOffsets[state + 1])
+    std::vector<uint32_t> _transitionOffsets;
+    std::vector<bool> _acceptStateFlags;
+    std::vector<StateId> _acceptStateList;
+    std::vector<State> _stateNames;
 };
@@ -1,99 +1,379 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include "dfa.hpp"
+#include "eclosure.hpp"
+#include "fa_statistics.hpp"
 #include "nfa.hpp"
+#include "state_set_table.hpp"
 
 namespace nfa2dfa {
 
-static DFA convertNFA2DFA(const NFA& nfa)
+// 子集构造的资源上限，DFA的状态数最坏是NFA状态数的指数级，接受不可信的正则表达式时应当设置上限
+struct DeterminizationLimits
 {
-    const std::vector<InputType> inputSet = nfa.getNoneEmptyInputSet();
-    const auto determinationTransformRelation = nfa.getDeterminationTransformRelation();
-    const auto initialStateEClosure = nfa.getEClosure(nfa.getInitialState());
+    // DFA状态数的上限
+    size_t maxStates = SIZE_MAX;
+    // 随DFA规模增长的结构（状态组合的驻留表、新的状态转移）占用内存的上限，单位为字节
+    size_t maxMemoryBytes = SIZE_MAX;
+};
 
-    auto newInitialState = convertCombinationStateToString(initialStateEClosure);
+// 子集构造超出上限，调用者可以改用不需要确定化的NFA模拟（NFASimulator）
+// 附带诊断信息：超出时的DFA状态数、内存，以及最可能导致状态爆炸的NFA状态
+class DeterminizationLimitError : public std::runtime_error
+{
+public:
+    // 出现在部分（而不是全部）状态组合中的NFA状态，subsetCount为包含它的状态组合个数
+    // 这样的状态出现与否的组合越多（越接近全部组合的一半），越可能是状态爆炸的原因
+    struct HotState
+    {
+        StateId state;
+        size_t subsetCount;
+    };
 
-    // 已经处理过的状态组合(此状态是原状态组合之后的状态)
-    std::set<State> visitedStateSet;
-    // 待处理的状态组合(其中的状态为原始状态)
-    std::vector<std::set<State>> pendingStateSet;
-    pendingStateSet.push_back(initialStateEClosure);
+    DeterminizationLimitError(size_t stateCount, size_t memoryBytes, std::vector<HotState> hotStates)
+        : std::runtime_error(makeMessage(stateCount, memoryBytes, hotStates)),
+          _stateCount(stateCount),
+          _memoryBytes(memoryBytes),
+          _hotStates(std::move(hotStates))
+    {
+    }
 
-    // 新的规则列表
-    std::vector<DFARule> newRules;
-    // 新的终结状态
-    std::unordered_set<State> newFinalState;
+    size_t getStateCount() const
+    {
+        return _stateCount;
+    }
+
+    size_t getMemoryBytes() const
+    {
+        return _memoryBytes;
+    }
 
-    if (nfa.getAcceptStates().accept(initialStateEClosure))
+    // 按出现的组合数接近一半的程度排序
+    const std::vector<HotState>& getHotStates() const
     {
-        newFinalState.insert(newInitialState);
+        return _hotStates;
     }
 
-    std::set<State> finalStateEClosure;
+private:
+    static std::string makeMessage(size_t stateCount, size_t memoryBytes, const std::vector<HotState>& hotStates)
     {
-        // 由于NFA里可能存在某些状态接受空输入可以达到结束状态，这些关系没有优化
-        // 因此我们可以把这些状态也当作“终止”状态，后续子集构造中，只要遇到包含这些“终止”状态的组合，都可以看作新的DFA的终止状态
-        const auto stateList = nfa.getStateSet();
-        for (const auto& state : stateList)
+        auto message = "determinization exceeded the limit at " + std::to_string(stateCount) + " DFA states, " +
+                       std::to_string(memoryBytes) + " bytes; hot NFA states:";
+        for (const auto& [state, subsetCount] : hotStates)
         {
-            if (nfa.getAcceptStates().accept(nfa.getEClosure(state)))
-            {
-                finalStateEClosure.insert(state);
-            }
+            message += " " + std::to_string(state) + "(" + std::to_string(subsetCount) + ")";
         }
+        return message;
     }
 
-    NFAAcceptStates originAcceptedStateEClosure(finalStateEClosure);
+private:
+    size_t _stateCount;
+    size_t _memoryBytes;
+    std::vector<HotState> _hotStates;
+};
 
-    while (!pendingStateSet.empty())
+// 诊断时报告的NFA状态个数
+constexpr size_t MaxHotStates = 8;
+
+// 统计每个NFA状态出现在多少个状态组合中，返回出现在部分组合中、且最接近一半的若干个状态
+static std::vector<DeterminizationLimitError::HotState> getHotStates(const StateSetTable& stateSets, size_t nfaStateCount)
+{
+    std::vector<size_t> subsetCounts(nfaStateCount, 0);
+    for (StateId id = 0; id < stateSets.size(); id++)
     {
-        auto currentStartStateSet = pendingStateSet.back();
-        const auto currentStartStateStr = convertCombinationStateToString(currentStartStateSet);
-        pendingStateSet.pop_back();
-        visitedStateSet.insert(currentStartStateStr);
+        for (const auto state : stateSets.getStateSet(id))
+        {
+            subsetCounts[state]++;
+        }
+    }
 
-        for (const auto& input : inputSet)
+    std::vector<DeterminizationLimitError::HotState> hotStates;
+    for (StateId state = 0; state < nfaStateCount; state++)
+    {
+        if (subsetCounts[state] != 0 && subsetCounts[state] != stateSets.size())
         {
-            // 计算当前开始状态集下输入input所能到达的状态集
-            std::set<State> nextStateSet;
-            for (const auto& state : currentStartStateSet)
+            hotStates.push_back({state, subsetCounts[state]});
+        }
+    }
+    // 出现次数与不出现次数中较小的一个越大，状态越“活跃”；相同时按状态编号排序
+    const auto activity = [total = stateSets.size()](const DeterminizationLimitError::HotState& hotState) {
+        return std::min(hotState.subsetCount, total - hotState.subsetCount);
+    };
+    std::stable_sort(hotStates.begin(), hotStates.end(), [&activity](const auto& left, const auto& right) {
+        return activity(left) > activity(right);
+    });
+    if (hotStates.size() > MaxHotStates)
+    {
+        hotStates.resize(MaxHotStates);
+    }
+    return hotStates;
+}
+
+// 确定性状态转移表
+// 每个起始状态（包括其ε闭包中的状态）下接受的非空输入（字节类）所能达到的状态集合（有序），按起始状态、字节类升序连续保存
+struct DeterminationTransformRelation
+{
+    struct Entry
+    {
+        ByteClassId input;
+        // 能达到的状态集合为targets[targetBegin, targetEnd)
+        uint32_t targetBegin;
+        uint32_t targetEnd;
+    };
+
+    explicit DeterminationTransformRelation(std::pmr::memory_resource* resource)
+        : entryOffsets(resource),
+          entries(resource),
+          targets(resource)
+    {
+    }
+
+    // 某状态下的全部非空输入转移
+    std::span<const Entry> getEntries(StateId state) const
+    {
+        return std::span<const Entry>(entries).subspan(entryOffsets[state], entryOffsets[state + 1] - entryOffsets[state]);
+    }
+
+    std::span<const StateId> getTargets(const Entry& entry) const
+    {
+        return std::span<const StateId>(targets).subspan(entry.targetBegin, entry.targetEnd - entry.targetBegin);
+    }
+
+    // 状态i的转移为entries[entryOffsets[i], entryOffsets[i + 1])
+    std::pmr::vector<uint32_t> entryOffsets;
+    std::pmr::vector<Entry> entries;
+    std::pmr::vector<StateId> targets;
+};
+
+// 获取确定性状态转移表，全部内存从resource分配
+static DeterminationTransformRelation getDeterminationTransformRelation(const NFA& nfa,
+                                                                        const ByteClasses& byteClasses,
+                                                                        const EClosureTable& closures,
+                                                                        std::pmr::memory_resource* resource)
+{
+    // 预先计算每条非空转移的字节区间集合所覆盖的字节类，一条转移可以覆盖多个字节类
+    // 转移i覆盖的字节类为transitionClasses[transitionClassOffsets[i], transitionClassOffsets[i + 1])
+    const auto& transitions = nfa.getTransitions();
+    const auto& classMap = byteClasses.getClassMap();
+    std::pmr::vector<ByteClassId> transitionClasses(resource);
+    std::pmr::vector<uint32_t> transitionClassOffsets(resource);
+    transitionClassOffsets.reserve(transitions.size() + 1);
+    transitionClassOffsets.push_back(0);
+    std::pmr::vector<bool> covered(byteClasses.getClassCount(), false, resource);
+    for (const auto& transition : transitions)
+    {
+        if (transition.input)
+        {
+            const auto& bytes = transition.input->getBytes();
+            for (size_t byte = 0; byte < 256; byte++)
             {
-                if (!determinationTransformRelation.contains(state))
+                if (bytes.test(byte))
                 {
-                    continue;
+                    covered[classMap[byte]] = true;
                 }
-                const auto& transform = determinationTransformRelation.at(state);
-                if (!transform.contains(input))
+            }
+            for (size_t byteClass = 0; byteClass < covered.size(); byteClass++)
+            {
+                if (covered[byteClass])
                 {
-                    continue;
+                    transitionClasses.push_back(static_cast<ByteClassId>(byteClass));
+                    covered[byteClass] = false;
                 }
-                const auto& originNextStateSet = transform.at(input);
-                for (const auto& state : originNextStateSet)
+            }
+        }
+        transitionClassOffsets.push_back(static_cast<uint32_t>(transitionClasses.size()));
+    }
+
+    DeterminationTransformRelation relation(resource);
+    relation.entryOffsets.reserve(nfa.getStateCount() + 1);
+    relation.entryOffsets.push_back(0);
+    // 复用的缓冲区：当前状态的ε闭包，以及闭包中全部[字节类、下一个状态]
+    std::pmr::vector<StateId> closure(resource);
+    std::pmr::vector<std::pair<ByteClassId, StateId>> moves(resource);
+    for (StateId startState = 0; startState < nfa.getStateCount(); startState++)
+    {
+        moves.clear();
+        closures.getClosure(startState, closure);
+        for (const auto state : closure)
+        {
+            const auto stateTransitions = nfa.getTransitions(state);
+            const auto offset = static_cast<size_t>(stateTransitions.data() - transitions.data());
+            for (size_t i = 0; i < stateTransitions.size(); i++)
+            {
+                for (auto j = transitionClassOffsets[offset + i]; j < transitionClassOffsets[offset + i + 1]; j++)
                 {
-                    nextStateSet.insert(state);
+                    moves.emplace_back(transitionClasses[j], stateTransitions[i].nextState);
                 }
             }
-            if (nextStateSet.empty())
+        }
+
+        // 排序去重后相同字节类的状态连续且有序
+        std::sort(moves.begin(), moves.end());
+        moves.erase(std::unique(moves.begin(), moves.end()), moves.end());
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            if (i == 0 || moves[i].first != moves[i - 1].first)
             {
-                continue;
+                const auto targetBegin = static_cast<uint32_t>(relation.targets.size());
+                relation.entries.push_back({moves[i].first, targetBegin, targetBegin});
             }
+            relation.targets.push_back(moves[i].second);
+            relation.entries.back().targetEnd = static_cast<uint32_t>(relation.targets.size());
+        }
+        relation.entryOffsets.push_back(static_cast<uint32_t>(relation.entries.size()));
+    }
+    return relation;
+}
+
+// 子集构造，combinationStates返回每个新DFA状态对应的原状态组合（下标为新DFA的状态编号）
+// 子集构造得到的状态都是可以到达的，因此最后的trim不会改变状态编号
+// 构造过程中的临时结构（ε闭包、确定性状态转移表、状态组合的驻留表与各种缓冲区）都从resource分配，
+// 不指定时使用函数内部的单调内存池：分配只是移动指针，返回时一次性释放，多个线程同时构造时也不会竞争全局的分配器
+// 状态数或内存超出limits时抛出DeterminizationLimitError
+static DFA convertNFA2DFA(const NFA& nfa,
+                          std::vector<std::vector<StateId>>& combinationStates,
+                          const DeterminizationLimits& limits,
+                          std::pmr::memory_resource* resource = nullptr)
+{
+    if (resource == nullptr)
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        return convertNFA2DFA(nfa, combinationStates, limits, &arena);
+    }
+
+    combinationStates.clear();
 
-            auto newNextStateStr = convertCombinationStateToString(nextStateSet);
+    // 子集构造在字节类上进行，被所有状态转移同等对待的字节只需要处理一次
+    const auto byteClasses = nfa.getByteClasses();
+    // 全部状态的ε闭包只计算一次，确定性状态转移表与终止状态的判断都使用它
+    const EClosureTable closures(nfa, EClosureTable::DefaultBitsetStateLimit, resource);
+    const auto determinationTransformRelation = getDeterminationTransformRelation(nfa, byteClasses, closures, resource);
 
-            if (originAcceptedStateEClosure.accept(nextStateSet))
+    std::pmr::vector<StateId> initialStateEClosure(resource);
+    closures.getClosure(nfa.getInitialState(), initialStateEClosure);
+
+    // 状态组合（有序的原状态编号列表）到新DFA状态编号的映射，编号按第一次出现的顺序分配
+    StateSetTable combinationStateIds(resource);
+    // 待处理的状态组合的编号(其中的状态为原始状态)
+    std::pmr::vector<StateId> pendingStateSet(resource);
+
+    // 新的规则列表
+    std::vector<DFATransition> newTransitions;
+    // 新的终结状态
+    std::vector<StateId> newFinalState;
+
+    // 由于NFA里可能存在某些状态接受空输入可以达到结束状态，这些关系没有优化
+    // 因此我们可以把这些状态也当作“终止”状态，后续子集构造中，只要遇到包含这些“终止”状态的组合，都可以看作新的DFA的终止状态
+    const auto containsFinalState = [&closures](std::span<const StateId> stateSet) {
+        return std::any_of(stateSet.begin(), stateSet.end(), [&closures](StateId state) {
+            return closures.containsAcceptState(state);
+        });
+    };
+
+    const auto getMemoryBytes = [&] {
+        return combinationStateIds.getMemoryBytes() + newTransitions.capacity() * sizeof(DFATransition);
+    };
+    const auto throwLimitError = [&] {
+        throw DeterminizationLimitError(combinationStateIds.size(), getMemoryBytes(), getHotStates(combinationStateIds, nfa.getStateCount()));
+    };
+
+    // 获取状态组合对应的新状态，若是第一次遇到此组合则分配新的编号并加入待处理列表
+    const auto getCombinationState = [&](std::span<const StateId> stateSet) {
+        const auto [id, inserted] = combinationStateIds.intern(stateSet);
+        if (inserted)
+        {
+            if (combinationStateIds.size() > limits.maxStates)
+            {
+                throwLimitError();
+            }
+            FA_STATISTICS_ADD(subsetStates, 1);
+            if (containsFinalState(stateSet))
             {
-                newFinalState.insert(newNextStateStr);
+                newFinalState.push_back(id);
             }
-            if (!visitedStateSet.contains(newNextStateStr))
+            pendingStateSet.push_back(id);
+        }
+        return id;
+    };
+
+    const auto newInitialState = getCombinationState(initialStateEClosure);
+
+    // 复用的缓冲区：每个字节类下的下一个状态组合，以及当前状态组合下出现过的字节类
+    std::pmr::vector<std::pmr::vector<StateId>> nextStateSets(byteClasses.getClassCount(), resource);
+    std::pmr::vector<ByteClassId> inputs(resource);
+    while (!pendingStateSet.empty())
+    {
+        const auto currentStartState = pendingStateSet.back();
+        pendingStateSet.pop_back();
+        // 按字节类收集当前开始状态集下所能到达的状态，收集完之后才插入新的组合，因此驻留表中的span在此期间一直有效
+        for (const auto state : combinationStateIds.getStateSet(currentStartState))
+        {
+            for (const auto& entry : determinationTransformRelation.getEntries(state))
             {
-                pendingStateSet.push_back(std::move(nextStateSet));
+                auto& nextStateSet = nextStateSets[entry.input];
+                if (nextStateSet.empty())
+                {
+                    inputs.push_back(entry.input);
+                }
+                const auto targets = determinationTransformRelation.getTargets(entry);
+                nextStateSet.insert(nextStateSet.end(), targets.begin(), targets.end());
             }
+        }
+
+        // 按字节类升序分配新的状态组合
+        std::sort(inputs.begin(), inputs.end());
+        for (const auto input : inputs)
+        {
+            auto& nextStateSet = nextStateSets[input];
+            std::sort(nextStateSet.begin(), nextStateSet.end());
+            nextStateSet.erase(std::unique(nextStateSet.begin(), nextStateSet.end()), nextStateSet.end());
 
-            newRules.push_back(DFARule(currentStartStateStr, input, newNextStateStr));
+            const auto newNextState = getCombinationState(nextStateSet);
+            newTransitions.push_back({currentStartState, input, newNextState});
+            nextStateSet.clear();
+        }
+        inputs.clear();
+
+        if (getMemoryBytes() > limits.maxMemoryBytes)
+        {
+            throwLimitError();
         }
     }
 
-    return DFA(newInitialState, std::move(newRules), DFAAcceptStates(std::move(newFinalState))).trim();
+    combinationStates.reserve(combinationStateIds.size());
+    for (StateId state = 0; state < combinationStateIds.size(); state++)
+    {
+        const auto stateSet = combinationStateIds.getStateSet(state);
+        combinationStates.emplace_back(stateSet.begin(), stateSet.end());
+    }
+
+    return DFA(newInitialState, combinationStateIds.size(), std::move(newTransitions), newFinalState, byteClasses).trim();
+}
+
+static DFA convertNFA2DFA(const NFA& nfa,
+                          std::vector<std::vector<StateId>>& combinationStates,
+                          std::pmr::memory_resource* resource = nullptr)
+{
+    return convertNFA2DFA(nfa, combinationStates, DeterminizationLimits{}, resource);
+}
+
+static DFA convertNFA2DFA(const NFA& nfa, const DeterminizationLimits& limits, std::pmr::memory_resource* resource = nullptr)
+{
+    std::vector<std::vector<StateId>> combinationStates;
+    return convertNFA2DFA(nfa, combinationStates, limits, resource);
+}
+
+static DFA convertNFA2DFA(const NFA& nfa, std::pmr::memory_resource* resource = nullptr)
+{
+    return convertNFA2DFA(nfa, DeterminizationLimits{}, resource);
 }
 
-}// namespace nfa2dfa
\ No newline at end of file
+}// namespace nfa2dfa
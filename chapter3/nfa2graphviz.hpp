@@ -9,42 +9,36 @@ namespace nfa2graphviz {
 // 根据NFA生成graphviz
 static std::string nfa2graphviz(const NFA& nfa)
 {
-    auto initState = nfa.getInitialState();
+    const auto initState = nfa.getInitialState();
 
+    // 节点使用状态编号作为标识，使用展示名称作为标签
     std::vector<std::string> nodes;
-    auto stateSet = nfa.getStateSet();
-    for (const auto& state : stateSet)
+    for (StateId state = 0; state < nfa.getStateCount(); state++)
     {
-        if (state == initState && nfa.getAcceptStates().accept(state))
+        const auto name = nfa.getStateName(state);
+        if (state == initState && nfa.isAcceptState(state))
         {
-            nodes.push_back(std::format("{} [label=<{}>, shape=doublecircle, color=green]", state, state));
+            nodes.push_back(std::format("{} [label=<{}>, shape=doublecircle, color=green]", state, name));
         }
         else if (state == initState)
         {
-            nodes.push_back(std::format("{} [label=<{}>, shape=circle, color=green]", state, state));
+            nodes.push_back(std::format("{} [label=<{}>, shape=circle, color=green]", state, name));
         }
-        else if (nfa.getAcceptStates().accept(state))
+        else if (nfa.isAcceptState(state))
         {
-            nodes.push_back(std::format("{} [label=<{}>, shape=doublecircle, color=blue]", state, state));
+            nodes.push_back(std::format("{} [label=<{}>, shape=doublecircle, color=blue]", state, name));
         }
         else
         {
-            nodes.push_back(std::format("{} [label=<{}>, shape=circle]", state, state));
+            nodes.push_back(std::format("{} [label=<{}>, shape=circle]", state, name));
         }
     }
 
     std::vector<std::string> edges;
-    const auto& transformRelation = nfa.getTransformRelation();
-    for (const auto& [startState, transform] : transformRelation)
+    for (const auto& transition : nfa.getTransitions())
     {
-        for (const auto& [input, nextStateSet] : transform)
-        {
-            for (const auto& nextState : nextStateSet)
-            {
-                auto falg = input ? std::string{char(input.value())} : std::string("ε");
-                edges.push_back(std::format("{}->{} [label=<{}>]", startState, nextState, falg));
-            }
-        }
+        auto falg = transition.input ? transition.input->toString() : std::string("ε");
+        edges.push_back(std::format("{}->{} [label=<{}>]", transition.startState, transition.nextState, falg));
     }
 
     std::string graphviz = "digraph G{\n";
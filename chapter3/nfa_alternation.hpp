@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "fa_statistics.hpp"
 #include "nfa.hpp"
 
 namespace nfa_operator {
@@ -7,51 +8,49 @@ namespace nfa_operator {
 // N1 | N2
 static NFA alternation(const NFA& left, const NFA& right)
 {
-    const static std::string leftStatePrefix = "l";
-    const static std::string rightStatePrefix = "r";
+    // 新的起始状态编号为0，左边NFA的状态编号偏移1，右边NFA的状态编号偏移到左边NFA之后，以避免状态冲突
+    const StateId newInitialState = 0;
+    const StateId leftStateOffset = 1;
+    const auto rightStateOffset = static_cast<StateId>(leftStateOffset + left.getStateCount());
 
-    std::vector<NFARule> newRules;
+    std::vector<NFATransition> newTransitions;
+    newTransitions.reserve(left.getTransitions().size() + right.getTransitions().size() + 2);
 
-    // 根据状态前缀和状态转移表生成新的状态转移表
-    using TransformRelationType = std::map<State, std::map<std::optional<InputType>, std::set<State>>>;
-    const auto generateNewRule = [&newRules](const std::string& prefix, const TransformRelationType& transfromRelation) {
-        for (const auto& [startState, transform] : transfromRelation)
+    // 根据状态偏移和状态转移表生成新的状态转移表
+    const auto generateNewTransition = [&newTransitions](StateId offset, const NFA& nfa) {
+        for (const auto& transition : nfa.getTransitions())
         {
-            for (const auto& [input, stateSet] : transform)
-            {
-                for (const auto& nextState : stateSet)
-                {
-                    newRules.push_back(NFARule(prefix + startState, input, prefix + nextState));
-                }
-            }
+            newTransitions.push_back({transition.startState + offset, transition.input, transition.nextState + offset});
         }
     };
 
-    // 对左边的NFA施加前缀并添加新的关系
-    generateNewRule(leftStatePrefix, left.getTransformRelation());
+    FA_STATISTICS_ADD(ruleCopies, left.getTransitions().size() + right.getTransitions().size());
 
-    // 对右边的NFA施加前缀并添加新的关系
-    generateNewRule(rightStatePrefix, right.getTransformRelation());
+    // 对左边的NFA施加偏移并添加新的关系
+    generateNewTransition(leftStateOffset, left);
 
+    // 对右边的NFA施加偏移并添加新的关系
+    generateNewTransition(rightStateOffset, right);
 
-    // 添加前缀，然后合并为一个终止状态集
-    std::set<State> newFiniteStateSet;
-    for (const auto& state : left.getAcceptStates().getAcceptStateSet())
+
+    // 添加偏移，然后合并为一个终止状态集
+    std::vector<StateId> newFiniteStateList;
+    for (const auto state : left.getAcceptStateList())
     {
-        newFiniteStateSet.insert(leftStatePrefix + state);
+        newFiniteStateList.push_back(state + leftStateOffset);
     }
-    for (const auto& state : right.getAcceptStates().getAcceptStateSet())
+    for (const auto state : right.getAcceptStateList())
     {
-        newFiniteStateSet.insert(rightStatePrefix + state);
+        newFiniteStateList.push_back(state + rightStateOffset);
     }
 
-    // 构造新的起始状态，添加从新的起始状态接受空输入下转移到两个NFA起始状态的状态转移
-    const auto newInitialState = leftStatePrefix + left.getInitialState() + rightStatePrefix + right.getInitialState();
-    newRules.push_back(NFARule(newInitialState, std::nullopt, leftStatePrefix + left.getInitialState()));
-    newRules.push_back(NFARule(newInitialState, std::nullopt, rightStatePrefix + right.getInitialState()));
+    // 添加从新的起始状态接受空输入下转移到两个NFA起始状态的状态转移
+    newTransitions.push_back({newInitialState, std::nullopt, left.getInitialState() + leftStateOffset});
+    newTransitions.push_back({newInitialState, std::nullopt, right.getInitialState() + rightStateOffset});
 
     return NFA(newInitialState,
-               newRules,
-               NFAAcceptStates(newFiniteStateSet));
+               rightStateOffset + right.getStateCount(),
+               std::move(newTransitions),
+               newFiniteStateList);
 }
-}// namespace nfa_operator
\ No newline at end of file
+}// namespace nfa_operator
@@ -0,0 +1,221 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "nfa.hpp"
+
+// 共享结构的NFA构造器
+// nfa_operator中的连接、并、重复运算每次都会复制并重新编号操作数的全部状态转移，逐个组合k个自动机的代价是O(k^2)。
+// 构造器中的运算只记录一个引用操作数的节点（O(1)），片段是不可变的，可以被多次引用（每次引用在最终的NFA中各自占用一份状态）；
+// 最后build时按照与nfa_operator相同的方式为各个片段分配状态编号偏移，一次性生成NFA，因此时间与内存都与最终NFA的大小成线性关系。
+// 生成的NFA与用nfa_operator逐步组合得到的NFA完全相同（状态编号、状态转移与终止状态都相同）
+class NFABuilder
+{
+public:
+    // 片段的句柄，只能在创建它的构造器中使用
+    struct Fragment
+    {
+        uint32_t index;
+    };
+
+    // 把一个已有的NFA作为片段
+    Fragment add(NFA nfa)
+    {
+        Node node{NodeType::Leaf, static_cast<uint32_t>(_leaves.size()), 0};
+        node.stateCount = nfa.getStateCount();
+        node.transitionCount = nfa.getTransitions().size();
+        node.acceptStateCount = nfa.getAcceptStateList().size();
+        node.initialState = nfa.getInitialState();
+        _leaves.push_back(std::move(nfa));
+        return addNode(node);
+    }
+
+    // 顺序连接两个片段，同nfa_operator::concatenate
+    Fragment concatenate(Fragment front, Fragment tail)
+    {
+        const auto& frontNode = _nodes[front.index];
+        const auto& tailNode = _nodes[tail.index];
+        Node node{NodeType::Concatenate, front.index, tail.index};
+        node.stateCount = frontNode.stateCount + tailNode.stateCount;
+        node.transitionCount = frontNode.transitionCount + tailNode.transitionCount + frontNode.acceptStateCount;
+        node.acceptStateCount = tailNode.acceptStateCount;
+        node.initialState = frontNode.initialState;
+        return addNode(node);
+    }
+
+    // 并两个片段，同nfa_operator::alternation
+    Fragment alternation(Fragment left, Fragment right)
+    {
+        const auto& leftNode = _nodes[left.index];
+        const auto& rightNode = _nodes[right.index];
+        Node node{NodeType::Alternation, left.index, right.index};
+        node.stateCount = 1 + leftNode.stateCount + rightNode.stateCount;
+        node.transitionCount = leftNode.transitionCount + rightNode.transitionCount + 2;
+        node.acceptStateCount = leftNode.acceptStateCount + rightNode.acceptStateCount;
+        node.initialState = 0;
+        return addNode(node);
+    }
+
+    // 片段的克林闭包，同nfa_operator::repeat
+    Fragment repeat(Fragment fragment)
+    {
+        const auto& child = _nodes[fragment.index];
+        Node node{NodeType::Repeat, fragment.index, 0};
+        node.stateCount = child.stateCount + 1;
+        node.transitionCount = child.transitionCount + child.acceptStateCount + 1;
+        node.acceptStateCount = child.acceptStateCount + 1;
+        node.initialState = static_cast<StateId>(child.stateCount);
+        return addNode(node);
+    }
+
+    // 片段生成的NFA的状态数
+    size_t getStateCount(Fragment fragment) const
+    {
+        return _nodes[fragment.index].stateCount;
+    }
+
+    // 生成片段对应的NFA
+    // 不使用递归（片段可能嵌套得很深），用待处理栈保存[节点、状态编号偏移]
+    NFA build(Fragment fragment) const
+    {
+        const auto& root = _nodes[fragment.index];
+        std::vector<NFATransition> transitions;
+        transitions.reserve(root.transitionCount);
+        std::vector<StateId> acceptStates;
+
+        std::vector<std::pair<uint32_t, StateId>> pendingNodes = {{fragment.index, 0}};
+        while (!pendingNodes.empty())
+        {
+            const auto [index, offset] = pendingNodes.back();
+            pendingNodes.pop_back();
+            const auto& node = _nodes[index];
+            switch (node.type)
+            {
+                case NodeType::Leaf:
+                    for (const auto& transition : _leaves[node.first].getTransitions())
+                    {
+                        transitions.push_back({transition.startState + offset, transition.input, transition.nextState + offset});
+                    }
+                    break;
+                case NodeType::Concatenate:
+                {
+                    // 前面的片段保持偏移，后面的片段偏移到其后；前面片段的终止状态接受空输入转移到后面片段的起始状态
+                    const auto tailOffset = static_cast<StateId>(offset + _nodes[node.first].stateCount);
+                    pendingNodes.push_back({node.first, offset});
+                    pendingNodes.push_back({node.second, tailOffset});
+                    getAcceptStates(node.first, offset, acceptStates);
+                    for (const auto state : acceptStates)
+                    {
+                        transitions.push_back({state, std::nullopt, tailOffset + _nodes[node.second].initialState});
+                    }
+                    break;
+                }
+                case NodeType::Alternation:
+                {
+                    // 新的起始状态为偏移处的第一个状态，左右两个片段依次排在其后
+                    const auto leftOffset = static_cast<StateId>(offset + 1);
+                    const auto rightOffset = static_cast<StateId>(leftOffset + _nodes[node.first].stateCount);
+                    pendingNodes.push_back({node.first, leftOffset});
+                    pendingNodes.push_back({node.second, rightOffset});
+                    transitions.push_back({offset, std::nullopt, leftOffset + _nodes[node.first].initialState});
+                    transitions.push_back({offset, std::nullopt, rightOffset + _nodes[node.second].initialState});
+                    break;
+                }
+                case NodeType::Repeat:
+                {
+                    // 新的起始状态排在片段之后，片段的终止状态与新的起始状态都接受空输入转移到片段的起始状态
+                    const auto& child = _nodes[node.first];
+                    const auto childInitialState = static_cast<StateId>(offset + child.initialState);
+                    pendingNodes.push_back({node.first, offset});
+                    getAcceptStates(node.first, offset, acceptStates);
+                    for (const auto state : acceptStates)
+                    {
+                        transitions.push_back({state, std::nullopt, childInitialState});
+                    }
+                    transitions.push_back({static_cast<StateId>(offset + child.stateCount), std::nullopt, childInitialState});
+                    break;
+                }
+            }
+        }
+
+        getAcceptStates(fragment.index, 0, acceptStates);
+        return NFA(root.initialState, root.stateCount, std::move(transitions), acceptStates);
+    }
+
+private:
+    enum class NodeType
+    {
+        Leaf,
+        Concatenate,
+        Alternation,
+        Repeat,
+    };
+
+    struct Node
+    {
+        NodeType type;
+        // 叶子为_leaves中的下标，其他为操作数节点的下标
+        uint32_t first;
+        uint32_t second;
+        // 生成的NFA的规模，用于计算偏移以及预先分配内存
+        size_t stateCount = 0;
+        size_t transitionCount = 0;
+        size_t acceptStateCount = 0;
+        // 相对于片段偏移的起始状态
+        StateId initialState = 0;
+    };
+
+    Fragment addNode(const Node& node)
+    {
+        _nodes.push_back(node);
+        return {static_cast<uint32_t>(_nodes.size() - 1)};
+    }
+
+    // 获取某节点在某偏移下的终止状态，顺序与nfa_operator相同
+    void getAcceptStates(uint32_t index, StateId offset, std::vector<StateId>& acceptStates) const
+    {
+        acceptStates.clear();
+        // [节点、偏移]，节点为NoNode时表示偏移本身就是一个终止状态
+        std::vector<std::pair<uint32_t, StateId>> pendingNodes = {{index, offset}};
+        while (!pendingNodes.empty())
+        {
+            const auto [current, currentOffset] = pendingNodes.back();
+            pendingNodes.pop_back();
+            if (current == NoNode)
+            {
+                acceptStates.push_back(currentOffset);
+                continue;
+            }
+            const auto& node = _nodes[current];
+            switch (node.type)
+            {
+                case NodeType::Leaf:
+                    for (const auto state : _leaves[node.first].getAcceptStateList())
+                    {
+                        acceptStates.push_back(state + currentOffset);
+                    }
+                    break;
+                case NodeType::Concatenate:
+                    pendingNodes.push_back({node.second, static_cast<StateId>(currentOffset + _nodes[node.first].stateCount)});
+                    break;
+                case NodeType::Alternation:
+                    // 后处理的先入栈
+                    pendingNodes.push_back({node.second, static_cast<StateId>(currentOffset + 1 + _nodes[node.first].stateCount)});
+                    pendingNodes.push_back({node.first, static_cast<StateId>(currentOffset + 1)});
+                    break;
+                case NodeType::Repeat:
+                    pendingNodes.push_back({NoNode, static_cast<StateId>(currentOffset + _nodes[node.first].stateCount)});
+                    pendingNodes.push_back({node.first, currentOffset});
+                    break;
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    std::vector<Node> _nodes;
+    std::vector<NFA> _leaves;
+};
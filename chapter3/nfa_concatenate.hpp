@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "fa_statistics.hpp"
 #include "nfa.hpp"
 
 namespace nfa_operator {
@@ -7,45 +8,39 @@ namespace nfa_operator {
 // N1N2
 static NFA concatenate(const NFA& front, const NFA& tail)
 {
-    const static std::string frontStatePrefix = "f";
-    const static std::string tailStatePrefix = "t";
-
-    std::vector<NFARule> newRules;
-
-    // 根据状态前缀何状态转移表生成新的状态转移表
-    using TransformRelationType = std::map<State, std::map<std::optional<InputType>, std::set<State>>>;
-    const auto generateNewRule = [&newRules](const std::string& prefix, const TransformRelationType& transfromRelation) {
-        for (const auto& [startState, transform] : transfromRelation)
-        {
-            for (const auto& [input, stateSet] : transform)
-            {
-                for (const auto& nextState : stateSet)
-                {
-                    newRules.push_back(NFARule(prefix + startState, input, prefix + nextState));
-                }
-            }
-        }
-    };
-
-    // 对前面的NFA施加前缀并添加新的关系
-    generateNewRule(frontStatePrefix, front.getTransformRelation());
-
-    // 对侯面的NFA施加前缀并添加新的关系
-    generateNewRule(tailStatePrefix, tail.getTransformRelation());
+    // 前面的NFA保持原有编号，后面的NFA的状态编号整体偏移，以避免状态冲突
+    const auto tailStateOffset = static_cast<StateId>(front.getStateCount());
+
+    std::vector<NFATransition> newTransitions;
+    newTransitions.reserve(front.getTransitions().size() + tail.getTransitions().size() + front.getAcceptStateList().size());
+
+    FA_STATISTICS_ADD(ruleCopies, front.getTransitions().size() + tail.getTransitions().size());
+
+    // 添加前面的NFA的状态转移
+    newTransitions.insert(newTransitions.end(), front.getTransitions().begin(), front.getTransitions().end());
+
+    // 对后面的NFA施加偏移并添加新的关系
+    for (const auto& transition : tail.getTransitions())
+    {
+        newTransitions.push_back({transition.startState + tailStateOffset, transition.input, transition.nextState + tailStateOffset});
+    }
 
     // 生成从前面的NFA的终止状态转移接受空输入到后面NFA的起始状态的状态转移
-    for (const auto& state : front.getAcceptStates().getAcceptStateSet())
+    for (const auto state : front.getAcceptStateList())
     {
-        newRules.push_back(NFARule(frontStatePrefix + state, std::nullopt, tailStatePrefix + tail.getInitialState()));
+        newTransitions.push_back({state, std::nullopt, tail.getInitialState() + tailStateOffset});
     }
 
-    // 根据后面NFA的终止状态施加前缀，得到新的终止状态
-    std::set<State> newFiniteStateSet;
-    for (const auto& state : tail.getAcceptStates().getAcceptStateSet())
+    // 根据后面NFA的终止状态施加偏移，得到新的终止状态
+    std::vector<StateId> newFiniteStateList;
+    for (const auto state : tail.getAcceptStateList())
     {
-        newFiniteStateSet.insert(tailStatePrefix + state);
+        newFiniteStateList.push_back(state + tailStateOffset);
     }
 
-    return NFA(frontStatePrefix + front.getInitialState(), newRules, NFAAcceptStates(newFiniteStateSet));
+    return NFA(front.getInitialState(),
+               front.getStateCount() + tail.getStateCount(),
+               std::move(newTransitions),
+               newFiniteStateList);
 }
-}// namespace nfa_operator
\ No newline at end of file
+}// namespace nfa_operator
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "fa_statistics.hpp"
 #include "nfa.hpp"
 
 namespace nfa_operator {
@@ -7,27 +8,29 @@ namespace nfa_operator {
 // N1*
 static NFA repeat(const NFA& nfa)
 {
-    auto newRules = nfa.getRules();
+    auto newTransitions = nfa.getTransitions();
+    FA_STATISTICS_ADD(ruleCopies, newTransitions.size());
 
     // 添加从终止状态到初始状态在空输入下的状态转移
-    for (const auto& state : nfa.getAcceptStates().getAcceptStateSet())
+    for (const auto state : nfa.getAcceptStateList())
     {
-        newRules.push_back(NFARule(state, std::nullopt, nfa.getInitialState()));
+        newTransitions.push_back({state, std::nullopt, nfa.getInitialState()});
     }
 
-    // 构造新的起始状态
-    const auto newInitialState = "k" + nfa.getInitialState();
+    // 构造新的起始状态，使用原NFA之后的第一个编号
+    const auto newInitialState = static_cast<StateId>(nfa.getStateCount());
 
     // 在原终止状态集基础上，添加新的起始状态为终止状态
-    auto finiteStateSet = nfa.getAcceptStates().getAcceptStateSet();
-    finiteStateSet.insert(newInitialState);
+    auto finiteStateList = nfa.getAcceptStateList();
+    finiteStateList.push_back(newInitialState);
 
     // 构造从新的起始状态到原起始状态在空输入下的状态转移
-    newRules.push_back(NFARule(newInitialState, std::nullopt, nfa.getInitialState()));
+    newTransitions.push_back({newInitialState, std::nullopt, nfa.getInitialState()});
 
     // 使用新的起始状态、新的状态转移以及原终止状态构造克林闭包NFA
     return NFA(newInitialState,
-               newRules,
-               NFAAcceptStates(finiteStateSet));
+               nfa.getStateCount() + 1,
+               std::move(newTransitions),
+               finiteStateList);
 }
-}// namespace nfa_operator
\ No newline at end of file
+}// namespace nfa_operator
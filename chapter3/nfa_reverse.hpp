@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include "nfa.hpp"
+
+namespace nfa_operator {
+// 生成接受原NFA语言的反转的状态机，即：原NFA接受w当且仅当新NFA接受w的逆序
+static NFA reverse(const NFA& nfa)
+{
+    std::vector<NFATransition> newTransitions;
+    newTransitions.reserve(nfa.getTransitions().size() + nfa.getAcceptStateList().size());
+
+    // 所有状态转移反向
+    for (const auto& transition : nfa.getTransitions())
+    {
+        newTransitions.push_back({transition.nextState, transition.input, transition.startState});
+    }
+
+    // 构造新的起始状态，使用原NFA之后的第一个编号，并构造从新的起始状态到原终止状态在空输入下的状态转移
+    const auto newInitialState = static_cast<StateId>(nfa.getStateCount());
+    for (const auto state : nfa.getAcceptStateList())
+    {
+        newTransitions.push_back({newInitialState, std::nullopt, state});
+    }
+
+    // 原起始状态作为唯一的终止状态
+    return NFA(newInitialState,
+               nfa.getStateCount() + 1,
+               std::move(newTransitions),
+               {nfa.getInitialState()});
+}
+}// namespace nfa_operator
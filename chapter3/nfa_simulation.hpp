@@ -0,0 +1,321 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "byte_classes.hpp"
+#include "eclosure.hpp"
+#include "fa_statistics.hpp"
+#include "nfa.hpp"
+
+// NFA状态集合模拟器（Thompson模拟）
+// 构造时预先计算好每个状态的ε闭包以及按字节类索引的状态转移，之后可以反复用于匹配：
+// 1. 状态数较少时使用位集合表示当前状态集合，ε闭包也预先计算为位掩码，转移时直接按位或上目标状态的闭包掩码
+// 2. 状态数较多时（闭包掩码的内存为O(状态数^2)）改用稀疏状态集合，在转移时沿ε转移计算闭包
+// 两种方式的匹配内存都为O(状态数)，且只在每次匹配开始时分配一次
+// 需要分块提供输入时使用StreamMatcher
+class NFASimulator
+{
+public:
+    // 状态数不超过此值时使用位集合
+    static constexpr size_t DefaultBitsetStateLimit = 2048;
+
+    explicit NFASimulator(const NFA& nfa, size_t bitsetStateLimit = DefaultBitsetStateLimit)
+        : _stateCount(nfa.getStateCount()),
+          _initialState(nfa.getInitialState()),
+          _byteClasses(nfa.getByteClasses()),
+          _bitParallel(nfa.getStateCount() <= bitsetStateLimit),
+          _words((nfa.getStateCount() + 63) / 64)
+    {
+        // 按开始状态分别记录非空转移[字节类、下一个状态]与ε转移
+        _inputOffsets.assign(_stateCount + 1, 0);
+        _epsilonOffsets.assign(_stateCount + 1, 0);
+        for (StateId state = 0; state < _stateCount; state++)
+        {
+            for (const auto& transition : nfa.getTransitions(state))
+            {
+                if (transition.input)
+                {
+                    // 一条转移覆盖的每个字节类各记录一次
+                    for (const auto input : _byteClasses.getClasses(transition.input->getBytes()))
+                    {
+                        _inputTransitions.push_back({input, transition.nextState});
+                    }
+                }
+                else
+                {
+                    _epsilonTransitions.push_back(transition.nextState);
+                }
+            }
+            _inputOffsets[state + 1] = static_cast<uint32_t>(_inputTransitions.size());
+            _epsilonOffsets[state + 1] = static_cast<uint32_t>(_epsilonTransitions.size());
+        }
+
+        _acceptStateFlags.assign(_stateCount, false);
+        for (const auto state : nfa.getAcceptStateList())
+        {
+            _acceptStateFlags[state] = true;
+        }
+
+        if (_bitParallel)
+        {
+            _acceptMask.assign(_words, 0);
+            for (const auto state : nfa.getAcceptStateList())
+            {
+                _acceptMask[state / 64] |= uint64_t(1) << (state % 64);
+            }
+
+            // 使用相同的上限，闭包表也保存为位集合
+            const EClosureTable closures(nfa, bitsetStateLimit);
+            _closureMasks.resize(_stateCount * _words);
+            for (StateId state = 0; state < _stateCount; state++)
+            {
+                std::copy_n(closures.getMask(state), _words, &_closureMasks[state * _words]);
+            }
+        }
+    }
+
+    size_t getStateCount() const
+    {
+        return _stateCount;
+    }
+
+    // 是否使用位集合进行模拟
+    bool isBitParallel() const
+    {
+        return _bitParallel;
+    }
+
+    bool accept(std::string_view inputs) const
+    {
+        StreamMatcher matcher(*this);
+        matcher.feed(inputs);
+        return matcher.finish();
+    }
+
+    bool accept(const std::vector<InputType>& inputs) const
+    {
+        return accept(std::string_view(inputs.data(), inputs.size()));
+    }
+
+    // 流式匹配器：保存当前的NFA状态集合，输入可以分成多块（比如来自网络或文件的数据块）依次提供
+    // 状态集合所需的内存在构造时一次性分配，之后每次feed既不复制输入也不分配内存，因此可以用常量内存匹配任意长的数据流
+    // 匹配器引用构造它的NFASimulator，使用期间NFASimulator必须有效
+    class StreamMatcher
+    {
+    public:
+        explicit StreamMatcher(const NFASimulator& simulator)
+            : _simulator(simulator),
+              _currentStateSet(simulator._bitParallel ? 0 : simulator._stateCount),
+              _nextStateSet(simulator._bitParallel ? 0 : simulator._stateCount)
+        {
+            if (_simulator._bitParallel)
+            {
+                _currentMask.resize(_simulator._words);
+                _nextMask.resize(_simulator._words);
+            }
+            else
+            {
+                _pendingState.reserve(_simulator._stateCount);
+            }
+            reset();
+        }
+
+        // 回到初始状态，开始匹配一个新的数据流
+        void reset()
+        {
+            _dead = false;
+            if (_simulator._bitParallel)
+            {
+                const auto* mask = &_simulator._closureMasks[_simulator._initialState * _simulator._words];
+                std::copy(mask, mask + _simulator._words, _currentMask.begin());
+            }
+            else
+            {
+                _currentStateSet.clear();
+                _simulator.addEClosure(_currentStateSet, _simulator._initialState, _pendingState);
+            }
+        }
+
+        // 接受一块输入
+        void feed(std::span<const char> inputs)
+        {
+            if (_dead)
+            {
+                return;
+            }
+            _dead = _simulator._bitParallel ? !feedByBitset(inputs) : !feedBySparseSet(inputs);
+        }
+
+        // 判断到目前为止提供的全部输入是否被接受；不改变匹配状态，之后仍然可以继续feed
+        bool finish() const
+        {
+            if (_dead)
+            {
+                return false;
+            }
+            if (_simulator._bitParallel)
+            {
+                for (size_t word = 0; word < _simulator._words; word++)
+                {
+                    if (_currentMask[word] & _simulator._acceptMask[word])
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            return std::any_of(_currentStateSet.begin(), _currentStateSet.end(), [this](StateId state) {
+                return _simulator._acceptStateFlags[state];
+            });
+        }
+
+        // 当前状态集合是否为空，为空时之后的任何输入都不会被接受
+        bool isDead() const
+        {
+            return _dead;
+        }
+
+    private:
+        // 返回false表示状态集合变为空
+        bool feedByBitset(std::span<const char> inputs)
+        {
+            const auto& simulator = _simulator;
+            const auto words = simulator._words;
+
+            for (size_t position = 0; position < inputs.size(); position++)
+            {
+                const auto input = simulator._byteClasses.getClass(inputs[position]);
+                std::fill(_nextMask.begin(), _nextMask.end(), 0);
+                bool anyState = false;
+
+                for (size_t word = 0; word < words; word++)
+                {
+                    for (auto bits = _currentMask[word]; bits != 0; bits &= bits - 1)
+                    {
+                        const auto state = static_cast<StateId>(word * 64 + std::countr_zero(bits));
+                        for (auto i = simulator._inputOffsets[state]; i < simulator._inputOffsets[state + 1]; i++)
+                        {
+                            if (simulator._inputTransitions[i].input != input)
+                            {
+                                continue;
+                            }
+                            const auto* mask = &simulator._closureMasks[simulator._inputTransitions[i].nextState * words];
+                            for (size_t w = 0; w < words; w++)
+                            {
+                                _nextMask[w] |= mask[w];
+                            }
+                            anyState = true;
+                        }
+                    }
+                }
+
+                std::swap(_currentMask, _nextMask);
+                if (!anyState)
+                {
+                    FA_STATISTICS_ADD(bytesProcessed, position + 1);
+                    FA_STATISTICS_ADD(deadStateExits, 1);
+                    return false;
+                }
+            }
+            FA_STATISTICS_ADD(bytesProcessed, inputs.size());
+            return true;
+        }
+
+        bool feedBySparseSet(std::span<const char> inputs)
+        {
+            const auto& simulator = _simulator;
+
+            for (size_t position = 0; position < inputs.size(); position++)
+            {
+                const auto input = simulator._byteClasses.getClass(inputs[position]);
+                _nextStateSet.clear();
+                for (const auto state : _currentStateSet)
+                {
+                    for (auto i = simulator._inputOffsets[state]; i < simulator._inputOffsets[state + 1]; i++)
+                    {
+                        if (simulator._inputTransitions[i].input == input)
+                        {
+                            simulator.addEClosure(_nextStateSet, simulator._inputTransitions[i].nextState, _pendingState);
+                        }
+                    }
+                }
+                std::swap(_currentStateSet, _nextStateSet);
+
+                if (_currentStateSet.empty())
+                {
+                    FA_STATISTICS_ADD(bytesProcessed, position + 1);
+                    FA_STATISTICS_ADD(deadStateExits, 1);
+                    return false;
+                }
+            }
+            FA_STATISTICS_ADD(bytesProcessed, inputs.size());
+            return true;
+        }
+
+    private:
+        const NFASimulator& _simulator;
+        bool _dead = false;
+
+        // 位集合模式下的当前、下一个状态集合
+        std::vector<uint64_t> _currentMask;
+        std::vector<uint64_t> _nextMask;
+        // 稀疏集合模式下的当前、下一个状态集合
+        SparseStateSet _currentStateSet;
+        SparseStateSet _nextStateSet;
+        std::vector<StateId> _pendingState;
+    };
+
+private:
+    struct InputTransition
+    {
+        ByteClassId input;
+        StateId nextState;
+    };
+
+    void addEClosure(SparseStateSet& stateSet, StateId startState, std::vector<StateId>& pendingState) const
+    {
+        if (!stateSet.insert(startState))
+        {
+            return;
+        }
+        FA_STATISTICS_ADD(epsilonClosures, 1);
+        pendingState.push_back(startState);
+        while (!pendingState.empty())
+        {
+            const auto state = pendingState.back();
+            pendingState.pop_back();
+            for (auto i = _epsilonOffsets[state]; i < _epsilonOffsets[state + 1]; i++)
+            {
+                if (stateSet.insert(_epsilonTransitions[i]))
+                {
+                    pendingState.push_back(_epsilonTransitions[i]);
+                }
+            }
+        }
+    }
+
+private:
+    size_t _stateCount;
+    StateId _initialState;
+    ByteClasses _byteClasses;
+    bool _bitParallel;
+    // 位集合的字数
+    size_t _words;
+
+    // 状态state的非空转移位于 _inputTransitions[_inputOffsets[state], _inputOffsets[state + 1])
+    std::vector<InputTransition> _inputTransitions;
+    std::vector<uint32_t> _inputOffsets;
+    // 状态state的ε转移位于 _epsilonTransitions[_epsilonOffsets[state], _epsilonOffsets[state + 1])
+    std::vector<StateId> _epsilonTransitions;
+    std::vector<uint32_t> _epsilonOffsets;
+    std::vector<bool> _acceptStateFlags;
+
+    // 位集合模式下：每个状态的ε闭包掩码（_words个字一组）以及终止状态掩码
+    std::vector<uint64_t> _closureMasks;
+    std::vector<uint64_t> _acceptMask;
+};
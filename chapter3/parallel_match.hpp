@@ -0,0 +1,225 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "compiled_dfa.hpp"
+
+// 单个大输入的多线程匹配
+// 把输入切分为若干块，除第一块从初始状态开始之外，其余的块在各自的线程中同时从DFA的所有状态出发（推测执行），
+// 得到每块的 [出发状态 -> 结束状态、经过的终止状态个数] 映射，最后按顺序把各块的映射拼接起来得到整个输入的结果。
+// 从不同状态出发的路径通常会很快汇合到同一个状态，因此每隔一段输入就合并处于相同状态的路径，之后只需要推进不同的状态。
+// 如果合并之后仍然有过多不同的状态（DFA很大且路径不汇合），推测执行的代价会超过顺序执行，
+// 此时放弃这一块的推测，拼接时再从实际的状态顺序地执行这一块
+namespace parallel_match {
+
+// 每块的最小长度，输入较短时直接顺序执行
+constexpr size_t DefaultMinChunkSize = 256 * 1024;
+// 每隔多少字节合并一次处于相同状态的路径
+constexpr size_t MergeInterval = 256;
+// 合并之后仍然超过此数量的不同状态时放弃推测
+constexpr size_t MaxSpeculativeStates = 64;
+
+// 一块输入的推测执行结果，下标为出发状态的编号（行偏移 / 行宽）
+struct ChunkResult
+{
+    // 是否放弃了推测
+    bool abandoned = false;
+    std::vector<uint32_t> finalStates;
+    std::vector<size_t> acceptCounts;
+};
+
+// 判断下标为行偏移的可接受标记，避免匹配循环中的除法
+static std::vector<uint8_t> getAcceptFlagsByRow(const CompiledDFA& dfa)
+{
+    std::vector<uint8_t> flags(dfa.getStateCount() * dfa.getRowWidth(), 0);
+    for (size_t state = 0; state < dfa.getStateCount(); state++)
+    {
+        flags[state * dfa.getRowWidth()] = dfa.isAcceptState(static_cast<uint32_t>(state * dfa.getRowWidth()));
+    }
+    return flags;
+}
+
+// 从某个状态开始顺序执行，返回结束状态，acceptCount累加经过的终止状态个数（不包括出发状态）
+static uint32_t runSequential(const CompiledDFA& dfa, const std::vector<uint8_t>& acceptFlags, uint32_t state, std::string_view inputs, size_t& acceptCount, bool countAccept)
+{
+    if (!countAccept)
+    {
+        for (const auto input : inputs)
+        {
+            state = dfa.getNextState(state, input);
+        }
+        return state;
+    }
+
+    size_t count = 0;
+    for (const auto input : inputs)
+    {
+        state = dfa.getNextState(state, input);
+        count += acceptFlags[state];
+    }
+    acceptCount += count;
+    return state;
+}
+
+// 从所有状态出发推测执行一块输入
+static ChunkResult runSpeculative(const CompiledDFA& dfa, const std::vector<uint8_t>& acceptFlags, std::string_view inputs, bool countAccept)
+{
+    const auto stateCount = dfa.getStateCount();
+    const auto rowWidth = static_cast<uint32_t>(dfa.getRowWidth());
+
+    // 每条路径的当前状态（行偏移）以及自上次合并以来经过的终止状态个数
+    std::vector<uint32_t> lanes(stateCount);
+    std::vector<size_t> laneCounts(stateCount, 0);
+    for (uint32_t state = 0; state < stateCount; state++)
+    {
+        lanes[state] = state * rowWidth;
+    }
+
+    std::vector<uint32_t> laneOfRow(stateCount, UINT32_MAX);
+    std::vector<uint32_t> mergedLanes;
+    std::vector<uint32_t> newLaneOfLane;
+    // 合并处于相同状态的路径：laneOfOwner中记录的路径更新为合并之后的路径，并把各路径累计的终止状态个数转移到ownerCounts中
+    const auto mergeLanes = [&](std::vector<uint32_t>& laneOfOwner, std::vector<size_t>& ownerCounts) {
+        mergedLanes.clear();
+        newLaneOfLane.resize(lanes.size());
+        for (size_t lane = 0; lane < lanes.size(); lane++)
+        {
+            auto& merged = laneOfRow[lanes[lane] / rowWidth];
+            if (merged == UINT32_MAX)
+            {
+                merged = static_cast<uint32_t>(mergedLanes.size());
+                mergedLanes.push_back(lanes[lane]);
+            }
+            newLaneOfLane[lane] = merged;
+        }
+        for (const auto lane : lanes)
+        {
+            laneOfRow[lane / rowWidth] = UINT32_MAX;
+        }
+        for (size_t owner = 0; owner < laneOfOwner.size(); owner++)
+        {
+            ownerCounts[owner] += laneCounts[laneOfOwner[owner]];
+            laneOfOwner[owner] = newLaneOfLane[laneOfOwner[owner]];
+        }
+        lanes.swap(mergedLanes);
+        laneCounts.assign(lanes.size(), 0);
+    };
+    const auto runLanes = [&](std::string_view block) {
+        for (size_t lane = 0; lane < lanes.size(); lane++)
+        {
+            lanes[lane] = runSequential(dfa, acceptFlags, lanes[lane], block, laneCounts[lane], countAccept);
+        }
+    };
+
+    // 第一段：所有出发状态各自一条路径，合并之后的路径作为第二段的出发点
+    std::vector<uint32_t> laneOfState(stateCount);
+    std::vector<size_t> stateCounts(stateCount, 0);
+    for (uint32_t state = 0; state < stateCount; state++)
+    {
+        laneOfState[state] = state;
+    }
+    runLanes(inputs.substr(0, MergeInterval));
+    mergeLanes(laneOfState, stateCounts);
+    if (lanes.size() > MaxSpeculativeStates)
+    {
+        return {true, {}, {}};
+    }
+
+    // 第二段：只需要维护第一段合并之后的（不超过MaxSpeculativeStates条）路径的映射
+    std::vector<uint32_t> laneOfOrigin(lanes.size());
+    std::vector<size_t> originCounts(lanes.size(), 0);
+    for (uint32_t origin = 0; origin < laneOfOrigin.size(); origin++)
+    {
+        laneOfOrigin[origin] = origin;
+    }
+    for (size_t begin = MergeInterval; begin < inputs.size(); begin += MergeInterval)
+    {
+        runLanes(inputs.substr(begin, MergeInterval));
+        mergeLanes(laneOfOrigin, originCounts);
+    }
+
+    ChunkResult result;
+    result.finalStates.resize(stateCount);
+    result.acceptCounts.resize(stateCount);
+    for (uint32_t state = 0; state < stateCount; state++)
+    {
+        const auto origin = laneOfState[state];
+        result.finalStates[state] = lanes[laneOfOrigin[origin]];
+        result.acceptCounts[state] = stateCounts[state] + originCounts[origin];
+    }
+    return result;
+}
+
+// 多线程执行整个输入，返回结束状态，acceptCount返回经过的终止状态个数
+static uint32_t run(const CompiledDFA& dfa, std::string_view inputs, size_t threadCount, size_t minChunkSize, size_t& acceptCount, bool countAccept)
+{
+    const auto acceptFlags = countAccept ? getAcceptFlagsByRow(dfa) : std::vector<uint8_t>();
+    if (threadCount == 0)
+    {
+        threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    const auto chunkCount = std::max<size_t>(std::min(threadCount, inputs.size() / std::max<size_t>(minChunkSize, 1)), 1);
+    // 第chunk块为[size*chunk/chunkCount, size*(chunk+1)/chunkCount)，各块长度至多相差1且不会越过输入末尾
+    const auto chunkOf = [&](size_t chunk) {
+        const auto begin = inputs.size() * chunk / chunkCount;
+        return inputs.substr(begin, inputs.size() * (chunk + 1) / chunkCount - begin);
+    };
+
+    acceptCount = 0;
+    if (chunkCount == 1)
+    {
+        return runSequential(dfa, acceptFlags, dfa.getInitialState(), inputs, acceptCount, countAccept);
+    }
+
+    // 第一块在当前线程中从初始状态开始执行，其余的块在新线程中推测执行
+    std::vector<ChunkResult> results(chunkCount);
+    std::vector<std::thread> threads;
+    for (size_t chunk = 1; chunk < chunkCount; chunk++)
+    {
+        threads.emplace_back([&, chunk]() {
+            results[chunk] = runSpeculative(dfa, acceptFlags, chunkOf(chunk), countAccept);
+        });
+    }
+    auto state = runSequential(dfa, acceptFlags, dfa.getInitialState(), chunkOf(0), acceptCount, countAccept);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // 按顺序拼接每块的映射
+    for (size_t chunk = 1; chunk < chunkCount; chunk++)
+    {
+        const auto& result = results[chunk];
+        if (result.abandoned)
+        {
+            state = runSequential(dfa, acceptFlags, state, chunkOf(chunk), acceptCount, countAccept);
+            continue;
+        }
+        const auto index = state / dfa.getRowWidth();
+        acceptCount += result.acceptCounts[index];
+        state = result.finalStates[index];
+    }
+    return state;
+}
+
+// 判断DFA是否接受整个输入，threadCount为0时使用硬件线程数
+static bool accept(const CompiledDFA& dfa, std::string_view inputs, size_t threadCount = 0, size_t minChunkSize = DefaultMinChunkSize)
+{
+    size_t acceptCount = 0;
+    return dfa.isAcceptState(run(dfa, inputs, threadCount, minChunkSize, acceptCount, false));
+}
+
+// 统计输入的非空前缀中被DFA接受的个数，即读入每个字节之后处于终止状态的次数
+// 对于隐含.*前缀的非锚定DFA，就是输入中匹配的结束位置的个数
+static size_t countAcceptedPrefixes(const CompiledDFA& dfa, std::string_view inputs, size_t threadCount = 0, size_t minChunkSize = DefaultMinChunkSize)
+{
+    size_t acceptCount = 0;
+    run(dfa, inputs, threadCount, minChunkSize, acceptCount, true);
+    return acceptCount;
+}
+
+}// namespace parallel_match
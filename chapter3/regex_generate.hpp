@@ -1,73 +1,130 @@
 ﻿#pragma once
 
-#include <atomic>
 #include <exception>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "nfa_alternation.hpp"
+#include "nfa_builder.hpp"
 #include "nfa_concatenate.hpp"
 #include "nfa_repeat.hpp"
+#include "regex_parser.hpp"
+#include "thompson_emitter.hpp"
 
 namespace regex_generate {
 
-static std::atomic_int stateSeq;
-
-const static std::string InitialState = "i";
-const static std::string FinalState = "f";
-
+// 构造接受空输入的状态机，状态0为起始状态，状态1为终止状态
 static NFA Empty()
 {
-    auto seq = stateSeq.fetch_add(1);
-    auto seqStr = std::to_string(seq);
-
-    std::vector<NFARule> const rules = {
-            {seqStr + InitialState, std::nullopt, seqStr + FinalState},
+    std::vector<NFATransition> transitions = {
+            {0, std::nullopt, 1},
     };
-    NFAAcceptStates const acceptState({seqStr + FinalState});
-
-    NFA const nfa(seqStr + InitialState, rules, acceptState);
-    return nfa;
+    return NFA(0, 2, std::move(transitions), {1});
 }
 
 // 构造接受一个字符c的状态机
 static NFA Symbol(char c)
 {
-    auto seq = stateSeq.fetch_add(1);
-    auto seqStr = std::to_string(seq);
-    std::vector<NFARule> const rules = {
-            {seqStr + InitialState, c, seqStr + FinalState},
+    std::vector<NFATransition> transitions = {
+            {0, c, 1},
     };
-    NFAAcceptStates const acceptState({seqStr + FinalState});
-
-    NFA const nfa(seqStr + InitialState, rules, acceptState);
-    return nfa;
+    return NFA(0, 2, std::move(transitions), {1});
 }
 
 // 构造一个接受接受[start, end]区间内任意字符的状态机, 即： start | .. | end
+// 整个区间只需要一条以字节区间为输入的状态转移
 static NFA Range(char start, char end)
 {
     if (start > end)
     {
         throw std::exception("the range of start can't greater than end");
     }
-    else if (start == end)
-    {
-        return Symbol(end);
-    }
-    else
-    {
-        return nfa_operator::alternation(Symbol(start), Range(start + 1, end));
-    }
+
+    std::vector<NFATransition> transitions = {
+            {0, ByteRangeSet(start, end), 1},
+    };
+    return NFA(0, 2, std::move(transitions), {1});
 }
 
 // 构造接受字符串str的状态机
+// 与逐个字符连接的结果相同，通过NFABuilder一次性生成，避免每次连接都复制后面的全部状态转移
 static NFA Str(std::string_view str)
 {
     if (str.empty())
     {
         return Empty();
     }
-    return nfa_operator::concatenate(Symbol(str.front()), Str(str.substr(1, std::string_view::npos)));
+    NFABuilder builder;
+    auto fragment = builder.add(Symbol(str.back()));
+    for (auto it = str.rbegin() + 1; it != str.rend(); ++it)
+    {
+        fragment = builder.concatenate(builder.add(Symbol(*it)), fragment);
+    }
+    return builder.build(fragment);
+}
+
+// 把Thompson构造生成的转移保存为NFA的状态转移
+struct NFATransitionSink
+{
+    std::vector<NFATransition> transitions;
+
+    // 整个字节集合只需要一条以字节区间集合为输入的转移
+    void addBytes(StateId from, const ByteSet& bytes, StateId to)
+    {
+        transitions.push_back({from, ByteRangeSet(bytes), to});
+    }
+
+    void addEpsilon(StateId from, StateId to)
+    {
+        transitions.push_back({from, std::nullopt, to});
+    }
+};
+
+using ThompsonEmitter = BasicThompsonEmitter<ByteSet, NFATransitionSink>;
+
+// 根据语法树生成Thompson NFA，stateNodes返回每个NFA状态由哪个语法树节点生成
+static NFA emitNFA(const regex_parser::RegexAst& ast, std::vector<size_t>& stateNodes)
+{
+    NFATransitionSink sink;
+    ThompsonEmitter emitter(ast, sink);
+    const auto [start, end] = emitter.emit();
+    stateNodes = emitter.getStateNodes();
+    return NFA(start, emitter.getStateCount(), std::move(sink.transitions), {end});
+}
+
+// 正则表达式中的一段[begin, end)
+struct PatternSpan
+{
+    size_t begin;
+    size_t end;
+
+    std::string_view of(std::string_view pattern) const
+    {
+        return pattern.substr(begin, end - begin);
+    }
+};
+
+// 将正则表达式字符串编译为NFA，语法错误时抛出 regex_parser::RegexSyntaxError
+static NFA compile(std::string_view pattern)
+{
+    std::vector<size_t> stateNodes;
+    return emitNFA(regex_parser::parse(pattern), stateNodes);
+}
+
+// 同上，stateSpans返回每个NFA状态对应的正则表达式片段（生成该状态的语法树节点），
+// 用于把子集构造等分析得到的NFA状态对应回正则表达式
+static NFA compile(std::string_view pattern, std::vector<PatternSpan>& stateSpans)
+{
+    const auto ast = regex_parser::parse(pattern);
+    std::vector<size_t> stateNodes;
+    auto nfa = emitNFA(ast, stateNodes);
+    stateSpans.clear();
+    for (const auto node : stateNodes)
+    {
+        stateSpans.push_back({ast.nodes[node].begin, ast.nodes[node].end});
+    }
+    return nfa;
 }
 }// namespace regex_generate
\ No newline at end of file
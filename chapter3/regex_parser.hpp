@@ -0,0 +1,540 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "byte_classes.hpp"
+
+namespace regex_parser {
+
+// 正则表达式语法错误，position为出错的位置
+class RegexSyntaxError : public std::runtime_error
+{
+public:
+    RegexSyntaxError(const std::string& message, size_t position)
+        : std::runtime_error(message + " at position " + std::to_string(position)),
+          _position(position)
+    {
+    }
+
+    size_t position() const
+    {
+        return _position;
+    }
+
+private:
+    size_t _position;
+};
+
+// 表示无上限的重复次数
+constexpr int Unbounded = -1;
+
+// 语法树节点的类型
+enum class RegexNodeType
+{
+    // 空串
+    Empty,
+    // 接受字节集合中的任意一个字节（单个字符、字符类、.）
+    Bytes,
+    // 顺序连接所有子节点
+    Concatenate,
+    // 子节点中的任意一个
+    Alternation,
+    // 重复唯一的子节点[min, max]次，max为Unbounded时表示无上限
+    Repeat,
+};
+
+// 语法树节点，ByteSetType为字节集合的类型（编译期解析时使用constexpr的字节集合）
+template<typename ByteSetType>
+struct BasicRegexNode
+{
+    using Type = RegexNodeType;
+
+    Type type;
+    ByteSetType bytes;
+    std::vector<size_t> children;
+    int min = 0;
+    int max = 0;
+    // 节点在正则表达式中的位置[begin, end)
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+// 语法树，所有节点保存在一个数组中，子节点使用下标引用
+template<typename ByteSetType>
+struct BasicRegexAst
+{
+    std::vector<BasicRegexNode<ByteSetType>> nodes;
+    size_t root = 0;
+
+    constexpr const BasicRegexNode<ByteSetType>& getRoot() const
+    {
+        return nodes[root];
+    }
+};
+
+using RegexNode = BasicRegexNode<ByteSet>;
+using RegexAst = BasicRegexAst<ByteSet>;
+
+// 递归下降的正则表达式解析器，支持的语法：
+// 连接、|、*、+、?、{n}、{n,}、{n,m}、()、.、[...]、[^...]，
+// 以及转义 \d \D \w \W \s \S \n \r \t \f \v \xHH，其余的转义字符表示字符本身
+// 所有成员函数都是constexpr的，使用constexpr的字节集合实例化时可以在编译期解析（语法错误会成为编译错误）
+template<typename ByteSetType>
+class BasicRegexParser
+{
+    using Node = BasicRegexNode<ByteSetType>;
+    using Ast = BasicRegexAst<ByteSetType>;
+
+public:
+    // 单个重复运算的次数上限，避免展开之后的状态机过大
+    static constexpr int MaxRepeatCount = 1000;
+    // 展开全部重复之后的大小上限（按节点计数），嵌套的重复次数会相乘，比如((a{1000}){1000}){1000}
+    static constexpr size_t MaxExpandedSize = 100000;
+    // 括号的嵌套层数上限，同时也是语法树深度的上限（比如a????...），解析与生成NFA都是递归的，过深会导致栈溢出
+    static constexpr size_t MaxNestingDepth = 1000;
+
+    constexpr explicit BasicRegexParser(std::string_view pattern)
+        : _pattern(pattern),
+          _position(0)
+    {
+    }
+
+    constexpr Ast parse()
+    {
+        _ast.root = parseAlternation();
+        if (_position < _pattern.size())
+        {
+            // 只有多余的 ) 会使解析提前结束
+            throw RegexSyntaxError("unmatched ')'", _position);
+        }
+        return std::move(_ast);
+    }
+
+private:
+    // alternation := concatenation ('|' concatenation)*
+    constexpr size_t parseAlternation()
+    {
+        const auto begin = _position;
+        std::vector<size_t> children = {parseConcatenation()};
+        while (peek('|'))
+        {
+            _position++;
+            children.push_back(parseConcatenation());
+        }
+        if (children.size() == 1)
+        {
+            return children.front();
+        }
+        return addNode({RegexNodeType::Alternation, {}, std::move(children)}, begin);
+    }
+
+    // concatenation := repeat*
+    constexpr size_t parseConcatenation()
+    {
+        const auto begin = _position;
+        std::vector<size_t> children;
+        while (_position < _pattern.size() && !peek('|') && !peek(')'))
+        {
+            children.push_back(parseRepeat());
+        }
+        if (children.empty())
+        {
+            return addNode({RegexNodeType::Empty, {}, {}}, begin);
+        }
+        if (children.size() == 1)
+        {
+            return children.front();
+        }
+        return addNode({RegexNodeType::Concatenate, {}, std::move(children)}, begin);
+    }
+
+    // repeat := atom ('*' | '+' | '?' | '{' n (',' m?)? '}')*
+    constexpr size_t parseRepeat()
+    {
+        const auto begin = _position;
+        auto node = parseAtom();
+        while (_position < _pattern.size())
+        {
+            int min = 0;
+            int max = 0;
+            const auto c = _pattern[_position];
+            if (c == '*')
+            {
+                min = 0;
+                max = Unbounded;
+                _position++;
+            }
+            else if (c == '+')
+            {
+                min = 1;
+                max = Unbounded;
+                _position++;
+            }
+            else if (c == '?')
+            {
+                min = 0;
+                max = 1;
+                _position++;
+            }
+            else if (c == '{')
+            {
+                parseRepeatCount(min, max);
+            }
+            else
+            {
+                break;
+            }
+            Node repeat{RegexNodeType::Repeat, {}, {node}};
+            repeat.min = min;
+            repeat.max = max;
+            node = addNode(std::move(repeat), begin);
+        }
+        return node;
+    }
+
+    constexpr void parseRepeatCount(int& min, int& max)
+    {
+        const auto begin = _position++;
+        min = parseNumber();
+        max = min;
+        if (peek(','))
+        {
+            _position++;
+            max = peek('}') ? Unbounded : parseNumber();
+        }
+        if (!peek('}'))
+        {
+            throw RegexSyntaxError("expected '}'", _position);
+        }
+        _position++;
+        if (max != Unbounded && max < min)
+        {
+            throw RegexSyntaxError("invalid repeat count", begin);
+        }
+    }
+
+    constexpr int parseNumber()
+    {
+        const auto begin = _position;
+        int value = 0;
+        while (_position < _pattern.size() && _pattern[_position] >= '0' && _pattern[_position] <= '9')
+        {
+            value = value * 10 + (_pattern[_position] - '0');
+            if (value > MaxRepeatCount)
+            {
+                throw RegexSyntaxError("repeat count is too large", begin);
+            }
+            _position++;
+        }
+        if (_position == begin)
+        {
+            throw RegexSyntaxError("expected a number", _position);
+        }
+        return value;
+    }
+
+    // atom := '(' alternation ')' | '[' class ']' | '.' | escape | literal
+    constexpr size_t parseAtom()
+    {
+        const auto begin = _position;
+        const auto c = _pattern[_position];
+        switch (c)
+        {
+            case '(':
+            {
+                if (++_groupDepth > MaxNestingDepth)
+                {
+                    throw RegexSyntaxError("regex is nested too deeply", begin);
+                }
+                _position++;
+                const auto node = parseAlternation();
+                if (!peek(')'))
+                {
+                    throw RegexSyntaxError("unmatched '('", begin);
+                }
+                _position++;
+                _groupDepth--;
+                return node;
+            }
+            case '[':
+                return addBytes(parseClass(), begin);
+            case '.':
+            {
+                _position++;
+                ByteSetType bytes;
+                bytes.set();
+                return addBytes(bytes, begin);
+            }
+            case '\\':
+                return addBytes(parseEscape(), begin);
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+                throw RegexSyntaxError(std::string("nothing to repeat before '") + c + "'", _position);
+            default:
+            {
+                _position++;
+                ByteSetType bytes;
+                bytes.set(static_cast<unsigned char>(c));
+                return addBytes(bytes, begin);
+            }
+        }
+    }
+
+    // class := '^'? item+ ，item := char ('-' char)?
+    constexpr ByteSetType parseClass()
+    {
+        const auto begin = _position++;
+        bool negated = false;
+        if (peek('^'))
+        {
+            negated = true;
+            _position++;
+        }
+
+        ByteSetType bytes;
+        bool first = true;
+        while (true)
+        {
+            if (_position >= _pattern.size())
+            {
+                throw RegexSyntaxError("unmatched '['", begin);
+            }
+            // 紧跟在 [ 或 [^ 之后的 ] 表示字符本身
+            if (peek(']') && !first)
+            {
+                _position++;
+                break;
+            }
+            first = false;
+
+            const auto itemBegin = _position;
+            const auto low = parseClassChar();
+            if (peek('-') && _position + 1 < _pattern.size() && _pattern[_position + 1] != ']')
+            {
+                _position++;
+                const auto high = parseClassChar();
+                if (low.count() != 1 || high.count() != 1)
+                {
+                    throw RegexSyntaxError("invalid range in character class", itemBegin);
+                }
+                const auto lowByte = findFirstByte(low);
+                const auto highByte = findFirstByte(high);
+                if (lowByte > highByte)
+                {
+                    throw RegexSyntaxError("the range of start can't greater than end", itemBegin);
+                }
+                for (auto byte = lowByte; byte <= highByte; byte++)
+                {
+                    bytes.set(byte);
+                }
+            }
+            else
+            {
+                bytes |= low;
+            }
+        }
+
+        if (negated)
+        {
+            bytes.flip();
+        }
+        return bytes;
+    }
+
+    constexpr ByteSetType parseClassChar()
+    {
+        if (peek('\\'))
+        {
+            return parseEscape();
+        }
+        ByteSetType bytes;
+        bytes.set(static_cast<unsigned char>(_pattern[_position++]));
+        return bytes;
+    }
+
+    constexpr ByteSetType parseEscape()
+    {
+        const auto begin = _position++;
+        if (_position >= _pattern.size())
+        {
+            throw RegexSyntaxError("trailing '\\'", begin);
+        }
+        const auto c = _pattern[_position++];
+
+        ByteSetType bytes;
+        const auto setRange = [&bytes](char low, char high) {
+            for (auto byte = low; byte <= high; byte++)
+            {
+                bytes.set(static_cast<unsigned char>(byte));
+            }
+        };
+        switch (c)
+        {
+            case 'd':
+            case 'D':
+                setRange('0', '9');
+                break;
+            case 'w':
+            case 'W':
+                setRange('0', '9');
+                setRange('a', 'z');
+                setRange('A', 'Z');
+                bytes.set('_');
+                break;
+            case 's':
+            case 'S':
+                for (const auto space : std::string_view(" \t\n\r\f\v"))
+                {
+                    bytes.set(static_cast<unsigned char>(space));
+                }
+                break;
+            case 'n':
+                bytes.set('\n');
+                break;
+            case 'r':
+                bytes.set('\r');
+                break;
+            case 't':
+                bytes.set('\t');
+                break;
+            case 'f':
+                bytes.set('\f');
+                break;
+            case 'v':
+                bytes.set('\v');
+                break;
+            case 'x':
+                bytes.set(parseHexByte(begin));
+                break;
+            default:
+                bytes.set(static_cast<unsigned char>(c));
+                break;
+        }
+        if (c == 'D' || c == 'W' || c == 'S')
+        {
+            bytes.flip();
+        }
+        return bytes;
+    }
+
+    constexpr unsigned char parseHexByte(size_t begin)
+    {
+        int value = 0;
+        for (int i = 0; i < 2; i++)
+        {
+            if (_position >= _pattern.size())
+            {
+                throw RegexSyntaxError("invalid \\x escape", begin);
+            }
+            const auto c = _pattern[_position++];
+            int digit = 0;
+            if (c >= '0' && c <= '9')
+            {
+                digit = c - '0';
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                digit = c - 'a' + 10;
+            }
+            else if (c >= 'A' && c <= 'F')
+            {
+                digit = c - 'A' + 10;
+            }
+            else
+            {
+                throw RegexSyntaxError("invalid \\x escape", begin);
+            }
+            value = value * 16 + digit;
+        }
+        return static_cast<unsigned char>(value);
+    }
+
+    static constexpr size_t findFirstByte(const ByteSetType& bytes)
+    {
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            if (bytes.test(byte))
+            {
+                return byte;
+            }
+        }
+        return 256;
+    }
+
+    constexpr bool peek(char c) const
+    {
+        return _position < _pattern.size() && _pattern[_position] == c;
+    }
+
+    constexpr size_t addBytes(const ByteSetType& bytes, size_t begin)
+    {
+        return addNode({RegexNodeType::Bytes, bytes, {}}, begin);
+    }
+
+    // 添加节点，节点的位置为[begin, 当前位置)
+    constexpr size_t addNode(Node node, size_t begin)
+    {
+        node.begin = begin;
+        node.end = _position;
+        _expandedSizes.push_back(getExpandedSize(node));
+        if (_expandedSizes.back() > MaxExpandedSize)
+        {
+            throw RegexSyntaxError("regex is too large after expanding repeats", begin);
+        }
+        size_t depth = 1;
+        for (const auto child : node.children)
+        {
+            depth = std::max(depth, _nodeDepths[child] + 1);
+        }
+        if (depth > MaxNestingDepth)
+        {
+            throw RegexSyntaxError("regex is nested too deeply", begin);
+        }
+        _nodeDepths.push_back(depth);
+        _ast.nodes.push_back(std::move(node));
+        return _ast.nodes.size() - 1;
+    }
+
+    // 节点展开全部重复之后的大小，子节点都不超过上限，因此计算不会溢出
+    constexpr size_t getExpandedSize(const Node& node) const
+    {
+        size_t size = 1;
+        for (const auto child : node.children)
+        {
+            size += _expandedSizes[child];
+        }
+        if (node.type == RegexNodeType::Repeat)
+        {
+            // 无上限时展开为 min 个子节点再加一个循环的子节点
+            const auto count = node.max == Unbounded ? node.min + 1 : node.max;
+            size = 1 + _expandedSizes[node.children.front()] * static_cast<size_t>(count);
+        }
+        return size;
+    }
+
+private:
+    std::string_view _pattern;
+    size_t _position;
+    Ast _ast;
+    // 每个节点展开之后的大小，下标与_ast.nodes相同
+    std::vector<size_t> _expandedSizes;
+    // 每个节点在语法树中的深度（叶子节点为1）
+    std::vector<size_t> _nodeDepths;
+    // 当前所在的括号层数
+    size_t _groupDepth = 0;
+};
+
+using RegexParser = BasicRegexParser<ByteSet>;
+
+static RegexAst parse(std::string_view pattern)
+{
+    return RegexParser(pattern).parse();
+}
+
+}// namespace regex_parser
@@ -0,0 +1,160 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "fa_common.hpp"
+
+// 状态集合的驻留表（hash consing），用于子集构造中把NFA状态集合映射为稠密的DFA状态编号
+// 状态集合必须是有序且无重复的（规范形式），因此相同的集合只有一种表示，比较时先比较哈希值与长度，再逐个比较状态编号
+// 所有集合连续地保存在同一个数组中，哈希表使用开放寻址（线性探测），槽中只保存编号，插入时不会为每个集合单独分配内存
+// 全部内存从resource分配，子集构造中传入单调的内存池，构造结束后一次性释放
+class StateSetTable
+{
+public:
+    explicit StateSetTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : _elements(resource),
+          _offsets(resource),
+          _hashes(resource),
+          _slots(resource)
+    {
+        clear();
+    }
+
+    // 获取集合的编号，第一次出现时按出现顺序分配新的编号，返回[编号、是否是新插入的]
+    std::pair<StateId, bool> intern(std::span<const StateId> stateSet)
+    {
+        const auto hash = getHash(stateSet);
+        auto slot = findSlot(stateSet, hash);
+        if (_slots[slot] != InvalidStateId)
+        {
+            return {_slots[slot], false};
+        }
+
+        const auto id = static_cast<StateId>(_hashes.size());
+        _elements.insert(_elements.end(), stateSet.begin(), stateSet.end());
+        _offsets.push_back(_elements.size());
+        _hashes.push_back(hash);
+        _slots[slot] = id;
+
+        // 装载因子超过1/2时扩容
+        if (_hashes.size() * 2 > _slots.size())
+        {
+            rehash(_slots.size() * 2);
+        }
+        return {id, true};
+    }
+
+    // 查找集合的编号，不存在时返回InvalidStateId
+    StateId find(std::span<const StateId> stateSet) const
+    {
+        return _slots[findSlot(stateSet, getHash(stateSet))];
+    }
+
+    // 获取编号对应的集合，之后插入新的集合会使返回的span失效
+    std::span<const StateId> getStateSet(StateId id) const
+    {
+        return std::span<const StateId>(_elements).subspan(_offsets[id], _offsets[id + 1] - _offsets[id]);
+    }
+
+    size_t size() const
+    {
+        return _hashes.size();
+    }
+
+    bool empty() const
+    {
+        return _hashes.empty();
+    }
+
+    // 全部集合占用的状态编号个数
+    size_t getElementCount() const
+    {
+        return _elements.size();
+    }
+
+    // 已分配的内存字节数
+    size_t getMemoryBytes() const
+    {
+        return _elements.capacity() * sizeof(StateId) + _offsets.capacity() * sizeof(size_t) + _hashes.capacity() * sizeof(uint64_t) +
+               _slots.capacity() * sizeof(StateId);
+    }
+
+    void clear()
+    {
+        _elements.clear();
+        _offsets.assign(1, 0);
+        _hashes.clear();
+        _slots.assign(InitialSlotCount, InvalidStateId);
+    }
+
+private:
+    static constexpr size_t InitialSlotCount = 16;
+
+    // 逐个混合状态编号，最后再做一次splitmix64的终结混合，使低位也充分依赖全部输入（槽位取哈希值的低位）
+    static uint64_t getHash(std::span<const StateId> stateSet)
+    {
+        uint64_t hash = stateSet.size() * 0x9E3779B97F4A7C15ull;
+        for (const auto state : stateSet)
+        {
+            hash = (hash ^ state) * 0xBF58476D1CE4E5B9ull;
+            hash ^= hash >> 29;
+        }
+        hash ^= hash >> 30;
+        hash *= 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 27;
+        hash *= 0x94D049BB133111EBull;
+        hash ^= hash >> 31;
+        return hash;
+    }
+
+    // 返回集合所在的槽，不存在时返回应插入的空槽
+    size_t findSlot(std::span<const StateId> stateSet, uint64_t hash) const
+    {
+        const auto mask = _slots.size() - 1;
+        for (auto slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask)
+        {
+            const auto id = _slots[slot];
+            if (id == InvalidStateId)
+            {
+                return slot;
+            }
+            if (_hashes[id] == hash)
+            {
+                const auto existing = getStateSet(id);
+                if (std::equal(existing.begin(), existing.end(), stateSet.begin(), stateSet.end()))
+                {
+                    return slot;
+                }
+            }
+        }
+    }
+
+    void rehash(size_t slotCount)
+    {
+        _slots.assign(slotCount, InvalidStateId);
+        const auto mask = slotCount - 1;
+        for (StateId id = 0; id < _hashes.size(); id++)
+        {
+            auto slot = static_cast<size_t>(_hashes[id]) & mask;
+            while (_slots[slot] != InvalidStateId)
+            {
+                slot = (slot + 1) & mask;
+            }
+            _slots[slot] = id;
+        }
+    }
+
+private:
+    // 全部集合依次连续保存，集合i为[_offsets[i], _offsets[i + 1])
+    std::pmr::vector<StateId> _elements;
+    std::pmr::vector<size_t> _offsets;
+    // 每个集合的哈希值，比较与扩容时不需要重新计算
+    std::pmr::vector<uint64_t> _hashes;
+    // 开放寻址的哈希表，槽数为2的幂，空槽为InvalidStateId
+    std::pmr::vector<StateId> _slots;
+};
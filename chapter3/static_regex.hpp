@@ -0,0 +1,402 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "regex_parser.hpp"
+#include "thompson_emitter.hpp"
+
+// 编译期的正则表达式
+// StaticRegex<"pattern">在编译期完成整个流程：解析（与regex_parser相同的语法）、生成Thompson NFA、字节类划分、子集构造、
+// 最小化，得到一个static constexpr的状态转移表，运行时没有任何构造开销，匹配循环中表的大小与行宽都是常量。
+// 正则表达式的语法错误会成为编译错误。
+// 编译期的运算量与状态数的平方成正比，只适合较小的固定模式；模式较大时可能需要调高编译器的constexpr运算步数限制
+namespace static_regex {
+
+// 可以作为模板参数的字符串字面量
+template<size_t N>
+struct FixedString
+{
+    char value[N]{};
+
+    constexpr FixedString(const char (&string)[N])
+    {
+        std::copy_n(string, N, value);
+    }
+
+    constexpr std::string_view view() const
+    {
+        return {value, N - 1};
+    }
+};
+
+// 编译期使用的字节集合，提供解析器用到的std::bitset<256>的接口（C++20中std::bitset不是constexpr的）
+class ConstexprByteSet
+{
+public:
+    constexpr ConstexprByteSet& set()
+    {
+        for (auto& word : _words)
+        {
+            word = ~uint64_t(0);
+        }
+        return *this;
+    }
+
+    constexpr ConstexprByteSet& set(size_t byte)
+    {
+        _words[byte / 64] |= uint64_t(1) << (byte % 64);
+        return *this;
+    }
+
+    constexpr bool test(size_t byte) const
+    {
+        return (_words[byte / 64] >> (byte % 64)) & 1;
+    }
+
+    constexpr size_t count() const
+    {
+        size_t count = 0;
+        for (const auto word : _words)
+        {
+            count += std::popcount(word);
+        }
+        return count;
+    }
+
+    constexpr ConstexprByteSet& flip()
+    {
+        for (auto& word : _words)
+        {
+            word = ~word;
+        }
+        return *this;
+    }
+
+    constexpr ConstexprByteSet& operator|=(const ConstexprByteSet& other)
+    {
+        for (size_t i = 0; i < 4; i++)
+        {
+            _words[i] |= other._words[i];
+        }
+        return *this;
+    }
+
+private:
+    uint64_t _words[4]{};
+};
+
+// 编译期构造的DFA的表的容量（状态数 * 字节类数）
+// 编译期分配的内存不能保留到运行时，DFA保存在定长的数组中，才能作为一个constexpr变量同时给出表的大小与内容
+constexpr size_t MaxTableSize = 16384;
+
+// 编译期构造的DFA，状态0为死状态
+struct ConstexprDFA
+{
+    size_t stateCount = 0;
+    size_t classCount = 0;
+    std::array<uint8_t, 256> classMap{};
+    // 下标为 状态 * classCount + 字节类，只有前stateCount * classCount项有效
+    std::array<uint32_t, MaxTableSize> table{};
+    std::array<uint8_t, MaxTableSize> acceptStates{};
+    uint32_t initialState = 0;
+};
+
+// 编译期保存Thompson构造生成的转移，转移使用ConstexprByteSet
+struct ConstexprTransitionSink
+{
+    struct Transition
+    {
+        uint32_t startState;
+        // 为真表示ε转移
+        bool epsilon;
+        ConstexprByteSet bytes;
+        uint32_t nextState;
+    };
+
+    std::vector<Transition> transitions;
+
+    constexpr void addBytes(uint32_t from, const ConstexprByteSet& bytes, uint32_t to)
+    {
+        transitions.push_back({from, false, bytes, to});
+    }
+
+    constexpr void addEpsilon(uint32_t from, uint32_t to)
+    {
+        transitions.push_back({from, true, {}, to});
+    }
+};
+
+// 在编译期把正则表达式构造为最小化的DFA
+constexpr ConstexprDFA buildDFA(std::string_view pattern)
+{
+    const auto ast = regex_parser::BasicRegexParser<ConstexprByteSet>(pattern).parse();
+    ConstexprTransitionSink sink;
+    regex_generate::BasicThompsonEmitter<ConstexprByteSet, ConstexprTransitionSink> emitter(ast, sink);
+    const auto [nfaInitialState, nfaAcceptState] = emitter.emit();
+    const auto nfaStateCount = emitter.getStateCount();
+    const auto& transitions = sink.transitions;
+
+    // 按开始状态分组的转移
+    std::vector<std::vector<size_t>> transitionsOfState(nfaStateCount);
+    for (size_t i = 0; i < transitions.size(); i++)
+    {
+        transitionsOfState[transitions[i].startState].push_back(i);
+    }
+
+    // 字节类划分：依次用每条转移的字节集合细化划分，字节类按照第一次出现的字节的顺序编号
+    std::array<uint8_t, 256> classMap{};
+    size_t classCount = 1;
+    for (const auto& transition : transitions)
+    {
+        if (transition.epsilon)
+        {
+            continue;
+        }
+        std::vector<int> newClassOf(classCount * 2, -1);
+        size_t newClassCount = 0;
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            auto& newClass = newClassOf[classMap[byte] * 2 + transition.bytes.test(byte)];
+            if (newClass < 0)
+            {
+                newClass = static_cast<int>(newClassCount++);
+            }
+            classMap[byte] = static_cast<uint8_t>(newClass);
+        }
+        classCount = newClassCount;
+    }
+    std::vector<size_t> representatives(classCount, 256);
+    for (size_t byte = 256; byte-- > 0;)
+    {
+        representatives[classMap[byte]] = byte;
+    }
+
+    // 在状态集合上加入ε闭包，返回有序的状态集合
+    const auto closure = [&](std::vector<uint32_t> stateSet) {
+        std::vector<uint8_t> visited(nfaStateCount, 0);
+        for (const auto state : stateSet)
+        {
+            visited[state] = 1;
+        }
+        for (size_t i = 0; i < stateSet.size(); i++)
+        {
+            for (const auto index : transitionsOfState[stateSet[i]])
+            {
+                const auto next = transitions[index].nextState;
+                if (transitions[index].epsilon && !visited[next])
+                {
+                    visited[next] = 1;
+                    stateSet.push_back(next);
+                }
+            }
+        }
+        std::sort(stateSet.begin(), stateSet.end());
+        return stateSet;
+    };
+
+    // 子集构造，状态0为空集合（死状态）
+    std::vector<std::vector<uint32_t>> stateSets = {{}};
+    std::vector<std::vector<uint32_t>> rows;
+    const auto getState = [&stateSets](std::vector<uint32_t> stateSet) {
+        for (size_t state = 0; state < stateSets.size(); state++)
+        {
+            if (stateSets[state] == stateSet)
+            {
+                return static_cast<uint32_t>(state);
+            }
+        }
+        stateSets.push_back(std::move(stateSet));
+        return static_cast<uint32_t>(stateSets.size() - 1);
+    };
+    const auto initialState = getState(closure({nfaInitialState}));
+    for (size_t state = 0; state < stateSets.size(); state++)
+    {
+        std::vector<uint32_t> row(classCount);
+        for (size_t byteClass = 0; byteClass < classCount; byteClass++)
+        {
+            std::vector<uint32_t> nextStateSet;
+            for (const auto nfaState : stateSets[state])
+            {
+                for (const auto index : transitionsOfState[nfaState])
+                {
+                    if (!transitions[index].epsilon && transitions[index].bytes.test(representatives[byteClass]))
+                    {
+                        nextStateSet.push_back(transitions[index].nextState);
+                    }
+                }
+            }
+            row[byteClass] = getState(closure(std::move(nextStateSet)));
+        }
+        rows.push_back(std::move(row));
+    }
+    const auto stateCount = stateSets.size();
+    std::vector<uint8_t> acceptStates(stateCount, 0);
+    for (size_t state = 0; state < stateCount; state++)
+    {
+        acceptStates[state] = std::binary_search(stateSets[state].begin(), stateSets[state].end(), nfaAcceptState);
+    }
+
+    // 最小化（Moore算法）：按[所在分组、每个字节类下一个状态所在的分组]反复细化，直到分组数不再变化
+    // 分组按照第一个状态出现的顺序编号，因此死状态所在的分组总是0，与死状态等价的状态都会合并到死状态
+    std::vector<uint32_t> blockOf(stateCount);
+    for (size_t state = 0; state < stateCount; state++)
+    {
+        blockOf[state] = acceptStates[state] != acceptStates[0] ? 1 : 0;
+    }
+    size_t blockCount = 0;
+    while (true)
+    {
+        std::vector<std::vector<uint32_t>> signatures;
+        std::vector<uint32_t> newBlockOf(stateCount);
+        for (size_t state = 0; state < stateCount; state++)
+        {
+            std::vector<uint32_t> signature = {blockOf[state]};
+            for (const auto next : rows[state])
+            {
+                signature.push_back(blockOf[next]);
+            }
+            const auto it = std::find(signatures.begin(), signatures.end(), signature);
+            newBlockOf[state] = static_cast<uint32_t>(it - signatures.begin());
+            if (it == signatures.end())
+            {
+                signatures.push_back(std::move(signature));
+            }
+        }
+        blockOf = std::move(newBlockOf);
+        if (signatures.size() == blockCount)
+        {
+            break;
+        }
+        blockCount = signatures.size();
+    }
+
+    ConstexprDFA dfa;
+    dfa.stateCount = blockCount;
+    dfa.initialState = blockOf[initialState];
+    std::vector<size_t> representativeOfBlock(blockCount, stateCount);
+    for (size_t state = stateCount; state-- > 0;)
+    {
+        representativeOfBlock[blockOf[state]] = state;
+    }
+
+    // 合并在所有状态下转移都相同的字节类
+    std::vector<std::vector<uint32_t>> columns;
+    std::vector<uint8_t> newClassOf(classCount);
+    for (size_t byteClass = 0; byteClass < classCount; byteClass++)
+    {
+        std::vector<uint32_t> column(blockCount);
+        for (size_t block = 0; block < blockCount; block++)
+        {
+            column[block] = blockOf[rows[representativeOfBlock[block]][byteClass]];
+        }
+        const auto it = std::find(columns.begin(), columns.end(), column);
+        newClassOf[byteClass] = static_cast<uint8_t>(it - columns.begin());
+        if (it == columns.end())
+        {
+            columns.push_back(std::move(column));
+        }
+    }
+    dfa.classCount = columns.size();
+    for (size_t byte = 0; byte < 256; byte++)
+    {
+        dfa.classMap[byte] = newClassOf[classMap[byte]];
+    }
+
+    if (dfa.stateCount * dfa.classCount > MaxTableSize)
+    {
+        throw std::length_error("the DFA of the pattern is too large for StaticRegex");
+    }
+    for (size_t block = 0; block < blockCount; block++)
+    {
+        for (size_t byteClass = 0; byteClass < dfa.classCount; byteClass++)
+        {
+            dfa.table[block * dfa.classCount + byteClass] = columns[byteClass][block];
+        }
+        dfa.acceptStates[block] = acceptStates[representativeOfBlock[block]];
+    }
+    return dfa;
+}
+
+// 固定大小的状态转移表，状态编号使用能容纳状态数的最小整数类型
+template<size_t StateCount, size_t ClassCount>
+struct StaticDFATable
+{
+    using StateType = std::conditional_t<(StateCount <= 256), uint8_t, std::conditional_t<(StateCount <= 65536), uint16_t, uint32_t>>;
+
+    std::array<uint8_t, 256> classMap{};
+    std::array<StateType, StateCount * ClassCount> table{};
+    std::array<bool, StateCount> acceptStates{};
+    StateType initialState = 0;
+    // 接受汇点（可接受且任意输入都转移回自身），没有时为死状态0；最小化之后至多只有一个
+    StateType acceptSinkState = 0;
+};
+
+template<FixedString Pattern>
+class StaticRegex
+{
+private:
+    // 只构造一次DFA，再用其中的状态数与字节类数作为数组大小构造固定大小的表
+    static constexpr auto BuiltDFA = buildDFA(Pattern.view());
+
+public:
+    // 状态数（包括死状态）
+    static constexpr size_t StateCount = BuiltDFA.stateCount;
+    static constexpr size_t ClassCount = BuiltDFA.classCount;
+
+private:
+    static constexpr auto Table = [] {
+        StaticDFATable<StateCount, ClassCount> table;
+        using StateType = typename StaticDFATable<StateCount, ClassCount>::StateType;
+        table.classMap = BuiltDFA.classMap;
+        for (size_t i = 0; i < StateCount * ClassCount; i++)
+        {
+            table.table[i] = static_cast<StateType>(BuiltDFA.table[i]);
+        }
+        for (size_t state = 0; state < StateCount; state++)
+        {
+            table.acceptStates[state] = BuiltDFA.acceptStates[state] != 0;
+        }
+        table.initialState = static_cast<StateType>(BuiltDFA.initialState);
+        for (size_t state = 1; state < StateCount; state++)
+        {
+            const auto row = table.table.begin() + state * ClassCount;
+            if (table.acceptStates[state] && std::all_of(row, row + ClassCount, [state](StateType next) { return next == state; }))
+            {
+                table.acceptSinkState = static_cast<StateType>(state);
+                break;
+            }
+        }
+        return table;
+    }();
+
+    // 每处理这么多字节检查一次是否已经进入死状态或接受汇点
+    static constexpr size_t EarlyExitCheckInterval = 64;
+
+public:
+    // 判断整个输入是否匹配，也可以在编译期调用
+    // 进入死状态或接受汇点之后结果已经确定，不再处理剩余的输入
+    static constexpr bool accept(std::string_view inputs)
+    {
+        size_t state = Table.initialState;
+        size_t position = 0;
+        while (position < inputs.size() && state != 0 && state != Table.acceptSinkState)
+        {
+            const auto blockEnd = std::min(inputs.size(), position + EarlyExitCheckInterval);
+            for (; position < blockEnd; position++)
+            {
+                state = Table.table[state * ClassCount + Table.classMap[static_cast<unsigned char>(inputs[position])]];
+            }
+        }
+        return Table.acceptStates[state];
+    }
+};
+
+}// namespace static_regex
@@ -0,0 +1,124 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <atomic>
+#include <random>
+
+#include "batch_match.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+#include "work_stealing_pool.hpp"
+
+static std::vector<std::string> makeRandomInputs(size_t count, unsigned seed)
+{
+    std::mt19937 engine(seed);
+    std::vector<std::string> inputs(count);
+    for (auto& input : inputs)
+    {
+        input.resize(engine() % 12);
+        for (auto& c : input)
+        {
+            c = "abc@."[engine() % 5];
+        }
+    }
+    return inputs;
+}
+
+TEST_CASE("Test work stealing pool", "[Test work stealing pool]")
+{
+    for (size_t threadCount : {1, 2, 4, 7})
+    {
+        WorkStealingPool pool(threadCount);
+        REQUIRE(pool.getWorkerCount() == threadCount);
+
+        // 多次复用同一个线程池，每个任务都恰好执行一次
+        for (size_t round = 0; round < 5; round++)
+        {
+            const size_t taskCount = 1000 + round * 333;
+            // Catch2的断言不是线程安全的，工作线程中只记录结果
+            std::vector<std::atomic<int>> executed(taskCount);
+            std::atomic<bool> invalidWorker = false;
+            pool.parallelFor(taskCount, [&](size_t worker, size_t task) {
+                if (worker >= threadCount)
+                {
+                    invalidWorker = true;
+                }
+                // 前面的任务耗时更长，使其他线程需要窃取任务
+                if (task < taskCount / 8)
+                {
+                    volatile size_t sum = 0;
+                    for (size_t i = 0; i < 20000; i++)
+                    {
+                        sum = sum + i;
+                    }
+                }
+                executed[task]++;
+            });
+            REQUIRE(!invalidWorker);
+            for (const auto& count : executed)
+            {
+                REQUIRE(count == 1);
+            }
+        }
+
+        // 没有任务时直接返回
+        bool called = false;
+        pool.parallelFor(0, [&called](size_t, size_t) {
+            called = true;
+        });
+        REQUIRE(!called);
+    }
+}
+
+TEST_CASE("Test batch match", "[Test batch match]")
+{
+    const auto nfa = regex_generate::compile("[a-c]+@[a-c]+(\\.[a-c]+)+");
+    const CompiledDFA dfa(nfa2dfa::convertNFA2DFA(nfa).minimize());
+    const NFASimulator simulator(nfa);
+
+    const auto strings = makeRandomInputs(5000, 9);
+    std::vector<std::string_view> inputs(strings.begin(), strings.end());
+    inputs.push_back("ab@c.a");
+
+    for (size_t threadCount : {1, 3})
+    {
+        WorkStealingPool pool(threadCount);
+        const auto dfaResult = batch_match::matchBatch(dfa, inputs, pool);
+        const auto nfaResult = batch_match::matchBatch(simulator, inputs, pool);
+        REQUIRE(dfaResult.size() == inputs.size());
+        REQUIRE(nfaResult.size() == inputs.size());
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            REQUIRE(dfaResult[i] == dfa.accept(inputs[i]));
+            REQUIRE(nfaResult[i] == dfaResult[i]);
+        }
+        REQUIRE(dfaResult.back());
+        REQUIRE(batch_match::matchBatch(dfa, {}, pool).empty());
+    }
+}
+
+TEST_CASE("Benchmark batch match", "[.][benchmark]")
+{
+    const auto nfa = regex_generate::compile("[a-c]+@[a-c]+(\\.[a-c]+)+");
+    const auto minimized = nfa2dfa::convertNFA2DFA(nfa).minimize();
+    const CompiledDFA dfa(minimized);
+
+    const auto strings = makeRandomInputs(1000000, 3);
+    const std::vector<std::string_view> inputs(strings.begin(), strings.end());
+    WorkStealingPool pool;
+
+    BENCHMARK("DFA::accept loop 1M strings")
+    {
+        size_t count = 0;
+        for (const auto& input : strings)
+        {
+            count += minimized.accept(convertStringToInputs(input));
+        }
+        return count;
+    };
+
+    BENCHMARK("batch_match::matchBatch 1M strings")
+    {
+        return batch_match::matchBatch(dfa, inputs, pool).size();
+    };
+}
@@ -0,0 +1,123 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include "byte_classes.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "compiled_dfa.hpp"
+#include "dfa.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+
+TEST_CASE("Test byte class builder", "[Test byte class builder]")
+{
+    ByteSet lowercase;
+    for (char c = 'a'; c <= 'z'; c++)
+    {
+        lowercase.set(static_cast<unsigned char>(c));
+    }
+
+    ByteClassBuilder builder;
+    builder.add('a');
+    builder.add('b');
+    builder.add(lowercase);
+    builder.add(lowercase);
+    const auto byteClasses = builder.build();
+
+    // 划分为：[其他字节]、a、b、[c-z]
+    REQUIRE(byteClasses.getClassCount() == 4);
+    REQUIRE(byteClasses.getClass('a') != byteClasses.getClass('b'));
+    REQUIRE(byteClasses.getClass('c') == byteClasses.getClass('z'));
+    REQUIRE(byteClasses.getClass('A') == byteClasses.getClass('0'));
+    REQUIRE(byteClasses.getClass('A') != byteClasses.getClass('z'));
+    REQUIRE(byteClasses.toString(byteClasses.getClass('c')) == "[c-z]");
+    REQUIRE(byteClasses.toString(byteClasses.getClass('a')) == "a");
+    REQUIRE(byteClasses.getRepresentative(byteClasses.getClass('z')) == 'c');
+}
+
+TEST_CASE("Test DFA byte class compression", "[Test DFA byte class compression]")
+{
+    std::vector<DFARule> const rules = {
+            {"q0", 'a', "q1"},
+            {"q0", 'b', "q1"},
+            {"q1", 'a', "q1"},
+            {"q1", 'b', "q1"},
+    };
+    DFAAcceptStates const acceptState({"q1"});
+
+    DFA const dfa("q0", rules, acceptState);
+    REQUIRE(dfa.getByteClasses().getClassCount() == 3);
+
+    // a和b在所有状态下的行为都相同，合并之后只剩下[ab]和其他字节两个字节类
+    const auto compressed = dfa.compressByteClasses();
+    REQUIRE(compressed.getByteClasses().getClassCount() == 2);
+    REQUIRE(compressed.getTransitions().size() == 2);
+
+    const CompiledDFA compiled(compressed);
+    REQUIRE(compiled.getRowWidth() == 2);
+
+    const std::vector<std::pair<std::string, bool>> tests = {
+            {"abba", true},
+            {"a", true},
+            {"", false},
+            {"abc", false},
+    };
+
+    for (const auto& [input, expectedAccepted] : tests)
+    {
+        REQUIRE(expectedAccepted == compressed.accept(convertStringToInputs(input)));
+        REQUIRE(expectedAccepted == compiled.accept(input));
+    }
+}
+
+TEST_CASE("Test NFA2DFA over byte classes", "[Test NFA2DFA over byte classes]")
+{
+    const auto nfa = regex_generate::Str("abc");
+    const auto dfa = nfa2dfa::convertNFA2DFA(nfa);
+
+    REQUIRE(dfa.getByteClasses().getClassCount() == 4);
+    REQUIRE(dfa.accept(convertStringToInputs("abc")));
+    REQUIRE(!dfa.accept(convertStringToInputs("abd")));
+}
+
+TEST_CASE("Test byte range set", "[Test byte range set]")
+{
+    ByteRangeSet set('a', 'z');
+    REQUIRE(set.contains('a'));
+    REQUIRE(set.contains('m'));
+    REQUIRE(set.contains('z'));
+    REQUIRE_FALSE(set.contains('A'));
+    REQUIRE(set.getRanges().size() == 1);
+    REQUIRE(set.toString() == "[a-z]");
+    REQUIRE(ByteRangeSet('x').toString() == "x");
+
+    ByteSet bytes;
+    bytes.set('0');
+    bytes.set('1');
+    bytes.set('2');
+    bytes.set('a');
+    const ByteRangeSet discontinuous(bytes);
+    REQUIRE(discontinuous.getRanges().size() == 2);
+    REQUIRE(discontinuous.toString() == "[0-2a]");
+}
+
+TEST_CASE("Test NFA with range transitions", "[Test NFA with range transitions]")
+{
+    // 区间只需要一条转移，不再是a|b|...|z的选择链
+    const auto lowercase = regex_generate::Range('a', 'z');
+    REQUIRE(lowercase.getStateCount() == 2);
+    REQUIRE(lowercase.getTransitions().size() == 1);
+    REQUIRE(lowercase.accept(convertStringToInputs("a")));
+    REQUIRE(lowercase.accept(convertStringToInputs("q")));
+    REQUIRE(lowercase.accept(convertStringToInputs("z")));
+    REQUIRE_FALSE(lowercase.accept(convertStringToInputs("A")));
+    REQUIRE_FALSE(lowercase.accept(convertStringToInputs("ab")));
+
+    // 重叠的区间被划分为互不相交的字节类：[其他字节]、[a-f]、[g-z]、[0-9]
+    const auto nfa = regex_generate::compile("[a-z][a-f0-9]*");
+    REQUIRE(nfa.getByteClasses().getClassCount() == 4);
+
+    const auto dfa = nfa2dfa::convertNFA2DFA(nfa);
+    const auto compiled = CompiledDFA(dfa.minimize());
+    REQUIRE(compiled.accept("z09af"));
+    REQUIRE(compiled.accept("g"));
+    REQUIRE_FALSE(compiled.accept("zg"));
+    REQUIRE_FALSE(compiled.accept("0a"));
+}
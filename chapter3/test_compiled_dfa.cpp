@@ -0,0 +1,278 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "compiled_dfa.hpp"
+#include "mapped_file.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+
+static DFA makeTestDFA()
+{
+    std::vector<DFARule> const rules = {
+            {"q1", '0', "q1"},
+            {"q1", '1', "q2"},
+            {"q2", '0', "q3"},
+            {"q2", '1', "q2"},
+            {"q3", '0', "q2"},
+            {"q3", '1', "q2"},
+    };
+    DFAAcceptStates const acceptState({"q2"});
+    return DFA("q1", rules, acceptState);
+}
+
+static std::string makeRandomInput(size_t size, std::string_view alphabet, unsigned seed)
+{
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<size_t> distribution(0, alphabet.size() - 1);
+    std::string input(size, '\0');
+    for (auto& c : input)
+    {
+        c = alphabet[distribution(engine)];
+    }
+    return input;
+}
+
+TEST_CASE("Test compiled DFA", "[Test compiled DFA]")
+{
+    const auto dfa = makeTestDFA();
+    const CompiledDFA compiled(dfa);
+
+    REQUIRE(compiled.getStateCount() == dfa.getStateCount() + 1);
+
+    const std::vector<std::pair<std::string, bool>> tests = {
+            {"11", true},
+            {"0101010101", true},
+            {"001", true},
+            {"110", false},
+            {"", false},
+            {"012", false},
+    };
+
+    for (const auto& [input, expectedAccepted] : tests)
+    {
+        REQUIRE(expectedAccepted == compiled.accept(input));
+        REQUIRE(expectedAccepted == compiled.accept(convertStringToInputs(input)));
+    }
+}
+
+TEST_CASE("Test compiled DFA agrees with DFA", "[Test compiled DFA agrees with DFA]")
+{
+    // (abc|abcd)*
+    const auto nfa = nfa_operator::repeat(nfa_operator::alternation(regex_generate::Str("abc"), regex_generate::Str("abcd")));
+    const auto dfa = nfa2dfa::convertNFA2DFA(nfa);
+    const CompiledDFA compiled(dfa);
+
+    for (unsigned seed = 0; seed < 200; seed++)
+    {
+        const auto input = makeRandomInput(seed % 13, "abcd", seed);
+        REQUIRE(dfa.accept(convertStringToInputs(input)) == compiled.accept(input));
+    }
+    REQUIRE(compiled.accept("abcdabcabcabcd"));
+    REQUIRE(!compiled.accept("abcdabcabcab"));
+}
+
+TEST_CASE("Benchmark compiled DFA", "[.][benchmark]")
+{
+    const auto dfa = makeTestDFA();
+    const CompiledDFA compiled(dfa);
+
+    // 8MB的随机输入，以'1'结尾保证两者都需要处理完整个输入
+    auto input = makeRandomInput(8 * 1024 * 1024, "01", 42);
+    input.back() = '1';
+    const auto inputs = convertStringToInputs(input);
+
+    REQUIRE(dfa.accept(inputs) == compiled.accept(input));
+
+    BENCHMARK("DFA::accept 8MB")
+    {
+        return dfa.accept(inputs);
+    };
+
+    BENCHMARK("CompiledDFA::accept 8MB")
+    {
+        return compiled.accept(input);
+    };
+}
+
+TEST_CASE("Test compiled DFA stream matcher", "[Test compiled DFA stream matcher]")
+{
+    const CompiledDFA compiled(makeTestDFA());
+    CompiledDFA::StreamMatcher matcher(compiled);
+
+    const auto input = makeRandomInput(4096, "01", 7);
+    for (size_t chunkSize : {1, 3, 64, 1000, 4096})
+    {
+        matcher.reset();
+        for (size_t position = 0; position < input.size(); position += chunkSize)
+        {
+            matcher.feed(std::span<const char>(input.data() + position, std::min(chunkSize, input.size() - position)));
+        }
+        REQUIRE(matcher.finish() == compiled.accept(input));
+    }
+
+    // 空的数据块不改变状态
+    matcher.reset();
+    matcher.feed(std::string_view("1"));
+    matcher.feed(std::string_view(""));
+    REQUIRE(matcher.finish());
+
+    // 进入死状态之后不会再被接受
+    matcher.feed(std::string_view("2"));
+    REQUIRE(matcher.isDead());
+    matcher.feed(std::string_view("1"));
+    REQUIRE(!matcher.finish());
+}
+
+TEST_CASE("Test compiled DFA early exit", "[Test compiled DFA early exit]")
+{
+    // 子集构造得到的DFA中"ab"之后有多个接受汇点，编译时合并为一个
+    const auto dfa = nfa2dfa::convertNFA2DFA(regex_generate::compile("ab.*|c(d|e)*f"));
+    const CompiledDFA compiled(dfa);
+    REQUIRE(compiled.getAcceptSinkState() != CompiledDFA::DeadState);
+    REQUIRE(CompiledDFA(makeTestDFA()).getAcceptSinkState() == CompiledDFA::DeadState);
+
+    CompiledDFA::StreamMatcher matcher(compiled);
+    matcher.feed(std::string_view("ab"));
+    REQUIRE(matcher.isAcceptSink());
+    REQUIRE(matcher.getCurrentState() == compiled.getAcceptSinkState());
+    matcher.feed(std::string_view("xyz"));
+    REQUIRE(matcher.isAcceptSink());
+    REQUIRE(matcher.finish());
+
+    matcher.reset();
+    matcher.feed(std::string_view("x"));
+    REQUIRE(matcher.isDead());
+    REQUIRE(!matcher.isAcceptSink());
+
+    // 提前结束不改变结果
+    for (unsigned seed = 0; seed < 200; seed++)
+    {
+        const auto input = makeRandomInput(seed % 150, "abcdefx", seed);
+        const auto expected = dfa.accept(convertStringToInputs(input));
+        REQUIRE(compiled.accept(input) == expected);
+        matcher.reset();
+        for (size_t position = 0; position < input.size(); position += 7)
+        {
+            matcher.feed(std::span<const char>(input.data() + position, std::min<size_t>(7, input.size() - position)));
+        }
+        REQUIRE(matcher.finish() == expected);
+    }
+    REQUIRE(compiled.accept("ab" + std::string(10000, 'x')));
+    REQUIRE(!compiled.accept("x" + std::string(10000, 'f')));
+
+    // 序列化之后保留接受汇点，无效的接受汇点无法加载
+    const auto data = compiled.serialize();
+    REQUIRE(CompiledDFA::load(data).getAcceptSinkState() == compiled.getAcceptSinkState());
+    CompiledDFAFileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    auto badSink = data;
+    header.acceptSinkState = compiled.getInitialState();
+    std::memcpy(badSink.data(), &header, sizeof(header));
+    REQUIRE_THROWS_AS(CompiledDFA::load(badSink), CompiledDFAFormatError);
+}
+
+TEST_CASE("Benchmark compiled DFA early exit", "[.][benchmark]")
+{
+    // 大多数输入在前几个字节就已经确定结果
+    const CompiledDFA compiled(nfa2dfa::convertNFA2DFA(regex_generate::compile("GET .*|[a-z]+@[a-z]+")).minimize());
+    const auto accepted = "GET " + makeRandomInput(8 * 1024 * 1024, "abc/", 1);
+    const auto rejected = "PUT " + makeRandomInput(8 * 1024 * 1024, "abc/", 2);
+
+    BENCHMARK("accept-sink 8MB")
+    {
+        return compiled.accept(accepted);
+    };
+
+    BENCHMARK("dead state 8MB")
+    {
+        return compiled.accept(rejected);
+    };
+}
+
+TEST_CASE("Test compiled DFA serialization", "[Test compiled DFA serialization]")
+{
+    const auto dfa = makeTestDFA();
+    const CompiledDFA compiled(dfa);
+    const auto data = compiled.serialize();
+
+    const auto loaded = CompiledDFA::load(data);
+    REQUIRE(!loaded.isOwner());
+    REQUIRE(loaded.getStateCount() == compiled.getStateCount());
+    REQUIRE(loaded.getRowWidth() == compiled.getRowWidth());
+    REQUIRE(loaded.getInitialState() == compiled.getInitialState());
+    REQUIRE(loaded.serialize() == data);
+
+    // 状态名称
+    REQUIRE(loaded.getStateName(loaded.getInitialState()) == "q1");
+    REQUIRE(loaded.getStateName(CompiledDFA::DeadState).empty());
+    REQUIRE(CompiledDFA::load(CompiledDFA(nfa2dfa::convertNFA2DFA(regex_generate::Str("ab"))).serialize()).getStateName(0).empty());
+
+    // 复制与移动之后仍然有效
+    const auto copied = loaded;
+    auto owned = compiled;
+    const auto moved = std::move(owned);
+    REQUIRE(moved.isOwner());
+    REQUIRE(moved.getStateName(moved.getInitialState()) == "q1");
+
+    const auto input = makeRandomInput(10000, "01", 3);
+    for (size_t length = 0; length < input.size(); length += 97)
+    {
+        const auto prefix = std::string_view(input).substr(0, length);
+        REQUIRE(loaded.accept(prefix) == compiled.accept(prefix));
+        REQUIRE(copied.accept(prefix) == compiled.accept(prefix));
+        REQUIRE(moved.accept(prefix) == compiled.accept(prefix));
+    }
+}
+
+TEST_CASE("Test compiled DFA load from mapped file", "[Test compiled DFA load from mapped file]")
+{
+    const CompiledDFA compiled(nfa2dfa::convertNFA2DFA(regex_generate::compile("[a-z]+@[a-z]+(\\.[a-z]+)+")).minimize());
+    const auto data = compiled.serialize();
+
+    const std::string path = "test_compiled_dfa.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    {
+        const MappedFile file(path);
+        const auto loaded = CompiledDFA::load(file.getData(), false);
+        REQUIRE(loaded.accept("someone@example.com"));
+        REQUIRE(!loaded.accept("someone@example"));
+        REQUIRE(!loaded.accept("someone"));
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Test compiled DFA load invalid data", "[Test compiled DFA load invalid data]")
+{
+    const auto data = CompiledDFA(makeTestDFA()).serialize();
+    CompiledDFAFileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    // 数据不完整
+    REQUIRE_THROWS_AS(CompiledDFA::load(std::span(data).first(sizeof(header) - 1)), CompiledDFAFormatError);
+    REQUIRE_THROWS_AS(CompiledDFA::load(std::span(data).first(data.size() - 1)), CompiledDFAFormatError);
+
+    // 错误的文件头
+    auto badMagic = data;
+    badMagic[0] = std::byte{'X'};
+    REQUIRE_THROWS_AS(CompiledDFA::load(badMagic), CompiledDFAFormatError);
+
+    auto badVersion = data;
+    header.version = CompiledDFAFileHeader::CurrentVersion + 1;
+    std::memcpy(badVersion.data(), &header, sizeof(header));
+    REQUIRE_THROWS_AS(CompiledDFA::load(badVersion), CompiledDFAFormatError);
+
+    // 状态转移指向不存在的状态
+    auto badTransition = data;
+    std::memcpy(&header, data.data(), sizeof(header));
+    const uint32_t invalidState = 1000000;
+    std::memcpy(badTransition.data() + header.tableOffset, &invalidState, sizeof(invalidState));
+    REQUIRE_THROWS_AS(CompiledDFA::load(badTransition), CompiledDFAFormatError);
+}
@@ -0,0 +1,72 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <random>
+
+#include "catch2/catch_test_macros.hpp"
+#include "compiled_dfa.hpp"
+#include "dfa2cpp.hpp"
+#include "dfa2cpp_matchers.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+
+static std::string generate(std::string_view pattern)
+{
+    return dfa2cpp::dfa2cpp(nfa2dfa::convertNFA2DFA(regex_generate::compile(pattern)).minimize());
+}
+
+TEST_CASE("Test DFA2Cpp", "[Test DFA2Cpp]")
+{
+    const auto output = generate("a(b|c)*d");
+    REQUIRE(output.find("inline bool match(std::string_view inputs)") != std::string::npos);
+    REQUIRE(output.find("        case 0x62:\n        case 0x63:\n") != std::string::npos);
+    REQUIRE(output.find("return true;") != std::string::npos);
+    REQUIRE(output.find("        case 0x64:\n") != std::string::npos);
+
+    // 较长的区间使用范围比较
+    REQUIRE(generate("[a-z]+").find("if (current[-1] >= 0x61 && current[-1] <= 0x7a)") != std::string::npos);
+
+    // 覆盖字节最多的目标作为默认跳转，只有少数字节需要case标签
+    const auto negated = generate("[^a]");
+    REQUIRE(negated.find("        case 0x61:\n            return false;\n") != std::string::npos);
+    REQUIRE(negated.find("            break;\n    }\n    goto state") != std::string::npos);
+
+    // 进入接受汇点时直接接受，接受汇点不生成标号
+    const auto sink = generate("ab.*");
+    REQUIRE(sink.find("        case 0x62:\n            return true;\n") != std::string::npos);
+    REQUIRE(sink.find("state2:") == std::string::npos);
+    REQUIRE(generate(".*").find("state0:\n    return true;\n") != std::string::npos);
+
+    // 函数名称
+    REQUIRE(dfa2cpp::dfa2cpp(nfa2dfa::convertNFA2DFA(regex_generate::compile("a")), "isA").find("inline bool isA(") != std::string::npos);
+}
+
+TEST_CASE("Test DFA2Cpp generated matchers", "[Test DFA2Cpp generated matchers]")
+{
+    // dfa2cpp_matchers.hpp由generate_dfa2cpp_matchers在构建时生成（见CMakeLists.txt），模式必须与其一致
+    const std::vector<std::pair<std::string_view, bool (*)(std::string_view)>> matchers = {
+            {"a(b|c)*d", matchAbcd},
+            {"[a-z]+( [a-z]+)*", matchWords},
+            {"[^a]", matchNotA},
+            {"ab.*", matchAcceptSink},
+            {"-?(0|[1-9][0-9]*)(\\.[0-9]+)?", matchNumber},
+    };
+
+    std::mt19937 engine(17);
+    for (const auto& [pattern, matcher] : matchers)
+    {
+        const CompiledDFA dfa(nfa2dfa::convertNFA2DFA(regex_generate::compile(pattern)));
+        for (size_t test = 0; test < 2000; test++)
+        {
+            // 输入大多来自与模式相关的小字母表，偶尔出现任意字节
+            std::string input(engine() % 12, '\0');
+            for (auto& c : input)
+            {
+                c = engine() % 16 == 0 ? static_cast<char>(engine()) : "abcdz 019.-"[engine() % 11];
+            }
+            REQUIRE(matcher(input) == dfa.accept(input));
+        }
+    }
+
+    REQUIRE(matchAbcd("abcbd"));
+    REQUIRE(matchNumber("-10.25"));
+    REQUIRE(!matchNumber("01"));
+}
@@ -0,0 +1,289 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <random>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "dfa.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+
+// 生成随机的DFA，状态编号为0..stateCount-1，字母表为alphabet，每个转移以missingRate的概率缺失
+static DFA makeRandomDFA(std::mt19937& engine, size_t stateCount, std::string_view alphabet, double missingRate)
+{
+    std::uniform_int_distribution<StateId> stateDistribution(0, static_cast<StateId>(stateCount - 1));
+    std::uniform_real_distribution<double> rateDistribution(0, 1);
+
+    std::vector<DFARule> rules;
+    std::unordered_set<State> acceptStates;
+    for (size_t state = 0; state < stateCount; state++)
+    {
+        for (const auto input : alphabet)
+        {
+            if (rateDistribution(engine) >= missingRate)
+            {
+                rules.push_back(DFARule(std::to_string(state), input, std::to_string(stateDistribution(engine))));
+            }
+        }
+        if (rateDistribution(engine) < 0.3)
+        {
+            acceptStates.insert(std::to_string(state));
+        }
+    }
+    return DFA("0", rules, DFAAcceptStates(acceptStates));
+}
+
+// 暴力判断两个DFA是否等价：在两个DFA的乘积自动机上进行遍历，检查是否存在一个可达的状态对，其中一个接受而另一个不接受
+static bool bruteForceEquivalent(const DFA& left, const DFA& right, std::string_view alphabet)
+{
+    std::set<std::pair<StateId, StateId>> visited;
+    std::vector<std::pair<StateId, StateId>> pending = {{left.getInitialState(), right.getInitialState()}};
+    while (!pending.empty())
+    {
+        const auto [leftState, rightState] = pending.back();
+        pending.pop_back();
+        if (!visited.insert({leftState, rightState}).second)
+        {
+            continue;
+        }
+        const bool leftAccepted = leftState != InvalidStateId && left.isAcceptState(leftState);
+        const bool rightAccepted = rightState != InvalidStateId && right.isAcceptState(rightState);
+        if (leftAccepted != rightAccepted)
+        {
+            return false;
+        }
+        for (const auto input : alphabet)
+        {
+            const auto leftNext = leftState == InvalidStateId ? InvalidStateId : left.getNextState(leftState, input);
+            const auto rightNext = rightState == InvalidStateId ? InvalidStateId : right.getNextState(rightState, input);
+            if (leftNext != InvalidStateId || rightNext != InvalidStateId)
+            {
+                pending.push_back({leftNext, rightNext});
+            }
+        }
+    }
+    return true;
+}
+
+// 暴力计算DFA中等价状态的分组个数（表格填充法），只统计可以到达、且可以到达终止状态的状态
+static size_t bruteForceMinimalStateCount(const DFA& dfa, std::string_view alphabet)
+{
+    const auto trimmed = dfa.trim();
+    // 死状态的编号为n
+    const auto n = trimmed.getStateCount();
+    const auto next = [&](StateId state, InputType input) {
+        if (state == n)
+        {
+            return static_cast<StateId>(n);
+        }
+        const auto nextState = trimmed.getNextState(state, input);
+        return nextState == InvalidStateId ? static_cast<StateId>(n) : nextState;
+    };
+    const auto accepted = [&](StateId state) {
+        return state != n && trimmed.isAcceptState(state);
+    };
+
+    std::vector<std::vector<bool>> distinguishable(n + 1, std::vector<bool>(n + 1, false));
+    for (StateId i = 0; i <= n; i++)
+    {
+        for (StateId j = 0; j <= n; j++)
+        {
+            distinguishable[i][j] = accepted(i) != accepted(j);
+        }
+    }
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (StateId i = 0; i <= n; i++)
+        {
+            for (StateId j = 0; j <= n; j++)
+            {
+                if (distinguishable[i][j])
+                {
+                    continue;
+                }
+                for (const auto input : alphabet)
+                {
+                    if (distinguishable[next(i, input)][next(j, input)])
+                    {
+                        distinguishable[i][j] = true;
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // 统计与死状态不等价的状态的等价类个数
+    size_t count = 0;
+    std::vector<bool> counted(n + 1, false);
+    for (StateId i = 0; i < n; i++)
+    {
+        if (counted[i] || !distinguishable[i][n])
+        {
+            continue;
+        }
+        count++;
+        for (StateId j = i; j < n; j++)
+        {
+            if (!distinguishable[i][j])
+            {
+                counted[j] = true;
+            }
+        }
+    }
+    return count;
+}
+
+TEST_CASE("Test DFA minimize", "[Test DFA minimize]")
+{
+    // q1、q3在接受任意输入后都到达q2，它们是等价的；q4无法到达终止状态
+    std::vector<DFARule> const rules = {
+            {"q0", 'a', "q1"},
+            {"q0", 'b', "q3"},
+            {"q1", 'a', "q2"},
+            {"q3", 'a', "q2"},
+            {"q2", 'a', "q2"},
+            {"q2", 'b', "q4"},
+            {"q4", 'a', "q4"},
+    };
+    DFAAcceptStates const acceptState({"q2"});
+
+    DFA const dfa("q0", rules, acceptState);
+    const auto minimized = dfa.minimize();
+
+    REQUIRE(minimized.getStateCount() == 3);
+    REQUIRE(minimized.getInitialState() == 0);
+    REQUIRE(bruteForceEquivalent(dfa, minimized, "ab"));
+
+    // 终止状态与非终止状态即使转移相同也不能合并
+    std::vector<DFARule> const loopRules = {
+            {"q0", 'a', "q1"},
+            {"q1", 'a', "q1"},
+    };
+    DFA const loopDfa("q0", loopRules, DFAAcceptStates({"q1"}));
+    const auto minimizedLoop = loopDfa.minimize();
+    REQUIRE(minimizedLoop.getStateCount() == 2);
+    REQUIRE(!minimizedLoop.accept(convertStringToInputs("")));
+    REQUIRE(minimizedLoop.accept(convertStringToInputs("aaa")));
+
+    // 不接受任何输入的DFA最小化后只剩下一个状态
+    DFA const emptyDfa("q0", loopRules, DFAAcceptStates({}));
+    REQUIRE(emptyDfa.minimize().getStateCount() == 1);
+    REQUIRE(emptyDfa.minimize().getTransitions().empty());
+}
+
+TEST_CASE("Test DFA minimize against brute force", "[Test DFA minimize against brute force]")
+{
+    std::mt19937 engine(2024);
+    for (int i = 0; i < 200; i++)
+    {
+        const std::string_view alphabet = i % 2 == 0 ? "ab" : "abc";
+        const auto dfa = makeRandomDFA(engine, 1 + i % 23, alphabet, i % 3 == 0 ? 0.0 : 0.2);
+        const auto minimized = dfa.minimize();
+
+        REQUIRE(bruteForceEquivalent(dfa, minimized, alphabet));
+        const auto expectedStateCount = bruteForceMinimalStateCount(dfa, alphabet);
+        REQUIRE(minimized.getStateCount() == std::max<size_t>(expectedStateCount, 1));
+
+        // 最小化的结果是规范的，再次最小化不会有任何变化
+        const auto minimizedTwice = minimized.minimize();
+        REQUIRE(minimizedTwice.getStateCount() == minimized.getStateCount());
+        REQUIRE(minimizedTwice.getTransitions().size() == minimized.getTransitions().size());
+    }
+}
+
+TEST_CASE("Test NFA2DFA minimize", "[Test NFA2DFA minimize]")
+{
+    // (abc|abcd)* 的最小DFA：起始(接受)、a、ab、abc(接受)，共4个状态
+    const auto nfa = nfa_operator::repeat(nfa_operator::alternation(regex_generate::Str("abc"), regex_generate::Str("abcd")));
+    const auto dfa = nfa2dfa::convertNFA2DFA(nfa);
+    const auto minimized = dfa.minimize();
+    REQUIRE(minimized.getStateCount() == 4);
+    REQUIRE(bruteForceEquivalent(dfa, minimized, "abcd"));
+
+    // [a-z] 的各个字符在最小化之后行为相同，会被合并为同一个字节类
+    const auto range = nfa2dfa::convertNFA2DFA(regex_generate::Range('a', 'z')).minimize();
+    REQUIRE(range.getStateCount() == 2);
+    REQUIRE(range.getByteClasses().getClassCount() == 2);
+}
+
+TEST_CASE("Test DFA prune", "[Test DFA prune]")
+{
+    // q2无法到达终止状态
+    std::vector<DFARule> const rules = {
+            {"q0", 'a', "q1"},
+            {"q0", 'b', "q2"},
+            {"q2", 'a', "q2"},
+    };
+    const DFA dfa("q0", rules, DFAAcceptStates({"q1"}));
+    REQUIRE(dfa.getLiveStates() == std::vector<bool>{true, true, false});
+    const auto pruned = dfa.prune();
+    REQUIRE(pruned.getStateCount() == 2);
+    REQUIRE(pruned.getTransitions().size() == 1);
+    REQUIRE(bruteForceEquivalent(dfa, pruned, "ab"));
+
+    // 起始状态无法到达终止状态时只剩下起始状态
+    const DFA rejectAll("q0", rules, DFAAcceptStates({"q3"}));
+    REQUIRE(rejectAll.prune().getStateCount() == 1);
+    REQUIRE(rejectAll.prune().getTransitions().empty());
+
+    // 子集构造得到的"ab"之后的状态都是接受汇点，裁剪之后合并为一个只转移到自身的状态
+    const auto sinkDFA = nfa2dfa::convertNFA2DFA(regex_generate::compile("ab.*|c"));
+    const auto afterAB = sinkDFA.getNextState(sinkDFA.getNextState(sinkDFA.getInitialState(), 'a'), 'b');
+    REQUIRE(sinkDFA.isAcceptSink(afterAB));
+    REQUIRE(!sinkDFA.isAcceptSink(sinkDFA.getNextState(sinkDFA.getInitialState(), 'c')));
+    const auto prunedSink = sinkDFA.prune();
+    REQUIRE(prunedSink.getStateCount() < sinkDFA.getStateCount());
+    REQUIRE(bruteForceEquivalent(sinkDFA, prunedSink, "abcz"));
+    size_t sinkCount = 0;
+    for (StateId state = 0; state < prunedSink.getStateCount(); state++)
+    {
+        if (prunedSink.isAcceptSink(state))
+        {
+            sinkCount++;
+            for (const auto& transition : prunedSink.getTransitions(state))
+            {
+                REQUIRE(transition.nextState == state);
+            }
+        }
+    }
+    REQUIRE(sinkCount == 1);
+}
+
+TEST_CASE("Test DFA prune against brute force", "[Test DFA prune against brute force]")
+{
+    std::mt19937 engine(24);
+    for (int i = 0; i < 200; i++)
+    {
+        const auto dfa = makeRandomDFA(engine, 1 + i % 23, "ab", i % 3 == 0 ? 0.0 : 0.2);
+        const auto pruned = dfa.prune();
+        REQUIRE(bruteForceEquivalent(dfa, pruned, "ab"));
+        REQUIRE(pruned.getStateCount() <= dfa.trim().getStateCount());
+
+        // 裁剪之后除了起始状态，所有状态都能到达终止状态
+        const auto live = pruned.getLiveStates();
+        for (StateId state = 0; state < pruned.getStateCount(); state++)
+        {
+            REQUIRE((live[state] || state == pruned.getInitialState()));
+        }
+    }
+
+    for (const auto pattern : {".*", "a.*b", "(a|b)*.*c", "a(.*|b)c*", "(ab|.)*", "a.*|b.*|c"})
+    {
+        const auto dfa = nfa2dfa::convertNFA2DFA(regex_generate::compile(pattern));
+        REQUIRE(bruteForceEquivalent(dfa, dfa.prune(), "abcz"));
+        REQUIRE(bruteForceEquivalent(dfa, dfa.minimize().prune(), "abcz"));
+    }
+}
+
+TEST_CASE("Benchmark DFA minimize", "[.][benchmark]")
+{
+    std::mt19937 engine(1);
+    const auto dfa = makeRandomDFA(engine, 100000, "ab", 0.0);
+
+    BENCHMARK("DFA::minimize 100k states")
+    {
+        return dfa.minimize().getStateCount();
+    };
+}
@@ -0,0 +1,142 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <random>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "dfa_search.hpp"
+#include "regex_generate.hpp"
+
+// 逐个位置尝试所有区间的朴素实现，作为对照
+static std::vector<MatchSpan> bruteForceFindAll(const CompiledDFA& dfa, std::string_view inputs)
+{
+    std::vector<MatchSpan> result;
+    for (size_t position = 0; position <= inputs.size();)
+    {
+        std::optional<MatchSpan> match;
+        for (auto start = position; start <= inputs.size() && !match; start++)
+        {
+            for (auto end = inputs.size() + 1; end-- > start;)
+            {
+                if (dfa.accept(inputs.substr(start, end - start)))
+                {
+                    match = MatchSpan{start, end};
+                    break;
+                }
+            }
+        }
+        if (!match)
+        {
+            break;
+        }
+        result.push_back(match.value());
+        position = match->end > match->start ? match->end : match->end + 1;
+    }
+    return result;
+}
+
+TEST_CASE("Test DFA search", "[Test DFA search]")
+{
+    const DFASearcher searcher(regex_generate::compile("abcd|c|[0-9]+"));
+
+    // 最左优先：abcd从更左的位置开始，虽然c更早结束
+    REQUIRE(searcher.find("xxabcdxx") == MatchSpan{2, 6});
+    // 最长优先
+    REQUIRE(searcher.find("a12345b") == MatchSpan{1, 6});
+    REQUIRE(searcher.find("abxd") == std::nullopt);
+    REQUIRE(searcher.find("") == std::nullopt);
+    REQUIRE(searcher.find("abcd12", 1) == MatchSpan{2, 3});
+    REQUIRE(searcher.find("abcd12", 100) == std::nullopt);
+
+    const std::vector<MatchSpan> expected = {{0, 4}, {5, 6}, {7, 10}, {12, 13}, {13, 14}};
+    REQUIRE(searcher.findAll("abcd-c-123abcc") == expected);
+}
+
+TEST_CASE("Test DFA search empty match", "[Test DFA search empty match]")
+{
+    const DFASearcher searcher(regex_generate::compile("a*"));
+
+    REQUIRE(searcher.find("bbb") == MatchSpan{0, 0});
+    REQUIRE(searcher.find("baa") == MatchSpan{0, 0});
+    REQUIRE(searcher.find("baa", 1) == MatchSpan{1, 3});
+
+    // 空匹配之后从下一个位置继续查找
+    const std::vector<MatchSpan> expected = {{0, 0}, {1, 3}, {3, 3}, {4, 5}, {5, 5}};
+    REQUIRE(searcher.findAll("baaba") == expected);
+}
+
+TEST_CASE("Test DFA search agrees with brute force", "[Test DFA search agrees with brute force]")
+{
+    const std::vector<std::string> patterns = {
+            "ab|a",
+            "a(b|c)*d",
+            "(ab|abc)*c",
+            "b?a+b?",
+            "[a-c]{2,3}",
+            "a|a*b",
+    };
+    std::mt19937 engine(2024);
+
+    for (const auto& pattern : patterns)
+    {
+        const auto nfa = regex_generate::compile(pattern);
+        const DFASearcher searcher(nfa);
+        const CompiledDFA anchored(nfa2dfa::convertNFA2DFA(nfa).minimize());
+
+        for (size_t test = 0; test < 200; test++)
+        {
+            std::string input(engine() % 24, '\0');
+            for (auto& c : input)
+            {
+                c = "abcd"[engine() % 4];
+            }
+
+            const auto expected = bruteForceFindAll(anchored, input);
+            REQUIRE(searcher.findAll(input) == expected);
+            if (expected.empty())
+            {
+                REQUIRE(searcher.find(input) == std::nullopt);
+            }
+            else
+            {
+                REQUIRE(searcher.find(input) == expected.front());
+            }
+        }
+    }
+}
+
+TEST_CASE("Benchmark DFA search", "[.][benchmark]")
+{
+    // 16MB的模拟日志，大约每100行有一行包含错误码
+    std::mt19937 engine(7);
+    std::string log;
+    while (log.size() < 16 * 1024 * 1024)
+    {
+        log += "2024-01-01 12:00:00 INFO request served in ";
+        log += std::to_string(engine() % 1000);
+        log += "ms\n";
+        if (engine() % 100 == 0)
+        {
+            log += "2024-01-01 12:00:00 ERROR code=";
+            log += std::to_string(engine() % 100000);
+            log += "\n";
+        }
+    }
+
+    const DFASearcher searcher(regex_generate::compile("ERROR code=[0-9]+"));
+    const auto matches = searcher.findAll(log);
+    REQUIRE(!matches.empty());
+
+    // 吞吐量(MB/s) = 16 / 耗时(秒)
+    BENCHMARK("DFASearcher::findAll 16MB log")
+    {
+        return searcher.findAll(log).size();
+    };
+
+    const DFASearcher missingSearcher(regex_generate::compile("FATAL code=[0-9]+"));
+    REQUIRE(!missingSearcher.find(log));
+
+    BENCHMARK("DFASearcher::find 16MB log without match")
+    {
+        return missingSearcher.find(log).has_value();
+    };
+}
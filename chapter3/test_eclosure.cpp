@@ -0,0 +1,139 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <memory_resource>
+#include <random>
+
+#include "catch2/catch_test_macros.hpp"
+#include "eclosure.hpp"
+#include "nfa.hpp"
+
+namespace {
+
+// 统计分配次数的内存资源
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t getAllocationCount() const
+    {
+        return _allocationCount;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        _allocationCount++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    size_t _allocationCount = 0;
+};
+
+}// namespace
+
+// 随机的NFA，ε转移较多以产生环与较大的强连通分量
+static NFA makeRandomNFA(std::mt19937& engine, size_t stateCount)
+{
+    std::vector<NFATransition> transitions;
+    for (size_t i = 0; i < stateCount * 2; i++)
+    {
+        const auto from = static_cast<StateId>(engine() % stateCount);
+        const auto to = static_cast<StateId>(engine() % stateCount);
+        if (engine() % 3 == 0)
+        {
+            transitions.push_back({from, 'a', to});
+        }
+        else
+        {
+            transitions.push_back({from, std::nullopt, to});
+        }
+    }
+    std::vector<StateId> acceptStates;
+    for (StateId state = 0; state < stateCount; state++)
+    {
+        if (engine() % 7 == 0)
+        {
+            acceptStates.push_back(state);
+        }
+    }
+    return NFA(0, stateCount, std::move(transitions), acceptStates);
+}
+
+TEST_CASE("Test epsilon closure table", "[Test epsilon closure table]")
+{
+    std::mt19937 engine(20);
+    for (size_t test = 0; test < 200; test++)
+    {
+        const auto nfa = makeRandomNFA(engine, 1 + test % 150);
+        // 位集合与有序列表两种保存方式
+        for (const size_t bitsetStateLimit : {EClosureTable::DefaultBitsetStateLimit, size_t(0)})
+        {
+            const EClosureTable closures(nfa, bitsetStateLimit);
+            REQUIRE(closures.isBitset() == (bitsetStateLimit > 0));
+            for (StateId state = 0; state < nfa.getStateCount(); state++)
+            {
+                const auto expected = nfa.getEClosure(state);
+                REQUIRE(closures.getClosure(state) == expected);
+                REQUIRE(closures.containsAcceptState(state) == nfa.isAcceptState(expected));
+            }
+        }
+    }
+}
+
+TEST_CASE("Test epsilon closure components", "[Test epsilon closure components]")
+{
+    // 0 -> 1 -> 2 -> 0 构成一个分量，3单独一个分量
+    const NFA cycle(0, 4, {{0, std::nullopt, 1}, {1, std::nullopt, 2}, {2, std::nullopt, 0}, {2, 'a', 3}}, {3});
+    const EClosureTable closures(cycle);
+    REQUIRE(closures.getComponentCount() == 2);
+    REQUIRE(closures.getClosure(1) == std::vector<StateId>{0, 1, 2});
+    REQUIRE(closures.getClosure(3) == std::vector<StateId>{3});
+    REQUIRE(!closures.containsAcceptState(0));
+
+    // 很长的ε链不会因为递归过深而栈溢出
+    const size_t stateCount = 200000;
+    std::vector<NFATransition> transitions;
+    for (StateId state = 0; state + 1 < stateCount; state++)
+    {
+        transitions.push_back({state, std::nullopt, state + 1});
+    }
+    const NFA chain(0, stateCount, std::move(transitions), {static_cast<StateId>(stateCount - 1)});
+    const EClosureTable chainClosures(chain);
+    REQUIRE(!chainClosures.isBitset());
+    REQUIRE(chainClosures.getComponentCount() == stateCount);
+    REQUIRE(chainClosures.containsAcceptState(0));
+    REQUIRE(chainClosures.getClosure(stateCount - 3).size() == 3);
+}
+
+TEST_CASE("Test epsilon closure reuses traversal arrays", "[Test epsilon closure reuses traversal arrays]")
+{
+    // 不保存位集合时，多次求闭包复用表中的遍历数组，不再从resource分配
+    std::mt19937 engine(21);
+    const auto nfa = makeRandomNFA(engine, 300);
+    CountingResource resource;
+    const EClosureTable closures(nfa, 0, &resource);
+    std::vector<StateId> closure;
+    for (StateId state = 0; state < nfa.getStateCount(); state++)
+    {
+        closures.getClosure(state, closure);
+    }
+    const auto allocationCount = resource.getAllocationCount();
+    for (size_t round = 0; round < 3; round++)
+    {
+        for (StateId state = 0; state < nfa.getStateCount(); state++)
+        {
+            closures.getClosure(state, closure);
+            REQUIRE(closure == nfa.getEClosure(state));
+        }
+    }
+    REQUIRE(resource.getAllocationCount() == allocationCount);
+}
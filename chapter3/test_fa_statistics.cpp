@@ -0,0 +1,133 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <thread>
+
+#include "catch2/catch_test_macros.hpp"
+#include "compiled_dfa.hpp"
+#include "fa_statistics.hpp"
+#include "lazy_dfa.hpp"
+#include "nfa2dfa.hpp"
+#include "nfa_alternation.hpp"
+#include "nfa_concatenate.hpp"
+#include "nfa_repeat.hpp"
+#include "nfa_simulation.hpp"
+#include "regex_generate.hpp"
+
+TEST_CASE("Test construction statistics", "[Test construction statistics]")
+{
+    REQUIRE(fa_statistics::isEnabled());
+
+    const auto a = regex_generate::Symbol('a');
+    const auto b = regex_generate::Symbol('b');
+
+    fa_statistics::Collector collector;
+    const auto either = nfa_operator::alternation(a, b);
+    REQUIRE(collector.getStatistics().ruleCopies == a.getTransitions().size() + b.getTransitions().size());
+    const auto loop = nfa_operator::repeat(either);
+    const auto nfa = nfa_operator::concatenate(loop, a);
+    REQUIRE(collector.getStatistics().ruleCopies == a.getTransitions().size() + b.getTransitions().size() + either.getTransitions().size() + loop.getTransitions().size() + a.getTransitions().size());
+
+    const auto dfa = nfa2dfa::convertNFA2DFA(nfa);
+    REQUIRE(collector.getStatistics().subsetStates == dfa.getStateCount());
+    REQUIRE(collector.getStatistics().epsilonClosures > 0);
+
+    dfa.minimize();
+    REQUIRE(collector.getStatistics().minimizationRounds > 0);
+    REQUIRE(collector.getStatistics().bytesProcessed == 0);
+}
+
+TEST_CASE("Test match statistics", "[Test match statistics]")
+{
+    const auto nfa = regex_generate::compile("(ab)*c");
+    const auto dfa = nfa2dfa::convertNFA2DFA(nfa);
+    const CompiledDFA compiled(dfa);
+    const NFASimulator simulator(nfa);
+    LazyDFA lazy(nfa);
+
+    fa_statistics::Collector collector;
+    const auto& statistics = collector.getStatistics();
+
+    REQUIRE(dfa.accept(convertStringToInputs("ababc")));
+    REQUIRE(statistics.bytesProcessed == 5);
+    REQUIRE(statistics.deadStateExits == 0);
+
+    // 第二个字节就进入死状态
+    REQUIRE(!dfa.accept(convertStringToInputs("aaaaaa")));
+    REQUIRE(statistics.bytesProcessed == 7);
+    REQUIRE(statistics.deadStateExits == 1);
+
+    REQUIRE(!nfa.accept(convertStringToInputs("aaaaaa")));
+    REQUIRE(!simulator.accept("aaaaaa"));
+    REQUIRE(statistics.bytesProcessed == 11);
+    REQUIRE(statistics.deadStateExits == 3);
+
+    REQUIRE(compiled.accept("ababc"));
+    REQUIRE(statistics.bytesProcessed == 16);
+
+    // 惰性DFA第一次匹配时需要计算转移，第二次全部命中缓存
+    REQUIRE(lazy.accept("ababc"));
+    const auto cacheMisses = statistics.cacheMisses;
+    REQUIRE(cacheMisses > 0);
+    REQUIRE(cacheMisses <= 5);
+    REQUIRE(lazy.accept("ababc"));
+    REQUIRE(statistics.cacheMisses == cacheMisses);
+    REQUIRE(statistics.bytesProcessed == 26);
+
+    collector.reset();
+    REQUIRE(statistics.bytesProcessed == 0);
+}
+
+TEST_CASE("Test early exit statistics", "[Test early exit statistics]")
+{
+    const auto dfa = nfa2dfa::convertNFA2DFA(regex_generate::compile("ab.*"));
+    const CompiledDFA compiled(dfa);
+    const auto accepted = "ab" + std::string(100000, 'x');
+    const auto rejected = "ba" + std::string(100000, 'x');
+
+    fa_statistics::Collector collector;
+    const auto& statistics = collector.getStatistics();
+
+    // 进入接受汇点之后不再处理剩余的输入
+    REQUIRE(dfa.accept(convertStringToInputs(accepted)));
+    REQUIRE(statistics.bytesProcessed == 2);
+
+    // 编译后的DFA每处理一段输入检查一次
+    collector.reset();
+    REQUIRE(compiled.accept(accepted));
+    REQUIRE(statistics.bytesProcessed == CompiledDFA::EarlyExitCheckInterval);
+    collector.reset();
+    REQUIRE(!compiled.accept(rejected));
+    REQUIRE(statistics.bytesProcessed == CompiledDFA::EarlyExitCheckInterval);
+    REQUIRE(statistics.deadStateExits == 1);
+}
+
+TEST_CASE("Test statistics trace and scope", "[Test statistics trace and scope]")
+{
+    const auto dfa = nfa2dfa::convertNFA2DFA(regex_generate::compile("a+"));
+
+    std::vector<std::pair<std::string, uint64_t>> trace;
+    fa_statistics::Collector outer([&trace](std::string_view counter, uint64_t value) {
+        trace.push_back({std::string(counter), value});
+    });
+    {
+        // 嵌套的收集器生效期间，外层收集器不会收到统计
+        fa_statistics::Collector inner;
+        dfa.accept(convertStringToInputs("aaa"));
+        REQUIRE(inner.getStatistics().bytesProcessed == 3);
+    }
+    REQUIRE(outer.getStatistics().bytesProcessed == 0);
+    REQUIRE(trace.empty());
+
+    dfa.accept(convertStringToInputs("ab"));
+    REQUIRE(outer.getStatistics().bytesProcessed == 2);
+    REQUIRE(trace == std::vector<std::pair<std::string, uint64_t>>{{"bytesProcessed", 2}, {"deadStateExits", 1}});
+
+    // 统计按线程收集，其他线程没有收集器
+    bool hasCollector = true;
+    std::thread([&dfa, &hasCollector] {
+        hasCollector = fa_statistics::Collector::current() != nullptr;
+        dfa.accept(convertStringToInputs("aaaa"));
+    }).join();
+    REQUIRE(!hasCollector);
+    REQUIRE(outer.getStatistics().bytesProcessed == 2);
+    REQUIRE(outer.getStatistics().toString().find("bytesProcessed=2") != std::string::npos);
+}
@@ -0,0 +1,87 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <random>
+
+#include "catch2/catch_test_macros.hpp"
+#include "lazy_dfa.hpp"
+#include "regex_generate.hpp"
+
+// (a|b)*a(a|b){n}，即倒数第n+1个字符为a，其DFA的状态数为2^(n+1)
+static NFA makeExponentialNFA(int n)
+{
+    const auto ab = nfa_operator::alternation(regex_generate::Symbol('a'), regex_generate::Symbol('b'));
+    auto nfa = nfa_operator::concatenate(nfa_operator::repeat(ab), regex_generate::Symbol('a'));
+    for (int i = 0; i < n; i++)
+    {
+        nfa = nfa_operator::concatenate(nfa, ab);
+    }
+    return nfa;
+}
+
+// 生成随机输入，每个字符为a的概率为1/aFrequency
+static std::string makeRandomInput(std::mt19937& engine, size_t size, int aFrequency)
+{
+    std::uniform_int_distribution<int> distribution(0, aFrequency - 1);
+    std::string input(size, '\0');
+    for (auto& c : input)
+    {
+        c = distribution(engine) == 0 ? 'a' : 'b';
+    }
+    return input;
+}
+
+TEST_CASE("Test lazy DFA", "[Test lazy DFA]")
+{
+    // (abc|abcd)*
+    const auto nfa = nfa_operator::repeat(nfa_operator::alternation(regex_generate::Str("abc"), regex_generate::Str("abcd")));
+    LazyDFA lazyDfa(nfa);
+
+    // 构造时只有死状态
+    REQUIRE(lazyDfa.getCachedStateCount() == 1);
+
+    const std::vector<std::pair<std::string, bool>> tests = {
+            {"", true},
+            {"abc", true},
+            {"abcabcd", true},
+            {"abcdabcabcabcd", true},
+            {"ab", false},
+            {"abcab", false},
+            {"abcdd", false},
+    };
+
+    for (const auto& [input, expectedAccepted] : tests)
+    {
+        REQUIRE(expectedAccepted == lazyDfa.accept(input));
+    }
+    // 第二次匹配时命中缓存，结果不变
+    for (const auto& [input, expectedAccepted] : tests)
+    {
+        REQUIRE(expectedAccepted == lazyDfa.accept(convertStringToInputs(input)));
+    }
+    REQUIRE(lazyDfa.getCacheClearCount() == 0);
+}
+
+TEST_CASE("Test lazy DFA cache limit", "[Test lazy DFA cache limit]")
+{
+    const auto nfa = makeExponentialNFA(12);
+    std::mt19937 engine(3);
+
+    // 缓存上限较小，输入中的a较少，新状态出现得较慢，缓存满了之后会清空缓存继续以DFA的方式匹配
+    LazyDFA lazyDfa(nfa, 64 * 1024);
+    for (int i = 0; i < 20; i++)
+    {
+        const auto input = makeRandomInput(engine, 64 * 1024, 16);
+        REQUIRE(nfa.accept(convertStringToInputs(input)) == lazyDfa.accept(input));
+        REQUIRE(lazyDfa.getCacheBytes() <= 64 * 1024);
+    }
+    REQUIRE(lazyDfa.getCacheClearCount() > 0);
+
+    // 缓存上限极小时，清空缓存也无济于事，退化为NFA模拟
+    LazyDFA tinyLazyDfa(nfa, 1024);
+    for (int i = 0; i < 20; i++)
+    {
+        const auto input = makeRandomInput(engine, 1000 + i, 2);
+        REQUIRE(nfa.accept(convertStringToInputs(input)) == tinyLazyDfa.accept(input));
+        REQUIRE(tinyLazyDfa.getCacheBytes() <= 1024);
+    }
+    REQUIRE(tinyLazyDfa.getFallbackCount() > 0);
+}
@@ -0,0 +1,220 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <random>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "lexer.hpp"
+
+enum TokenType
+{
+    Keyword = 1,
+    Identifier,
+    Number,
+    Whitespace,
+    Operator,
+};
+
+static Lexer makeTestLexer()
+{
+    LexerBuilder builder;
+    builder.add("[a-z_][a-z0-9_]*", Identifier);
+    builder.add("if|else|while|return", Keyword, 1);
+    builder.add("[0-9]+", Number);
+    builder.add("[ \\t\\n]+", Whitespace);
+    builder.add("=|==|<|<=|\\+|-", Operator);
+    return builder.build();
+}
+
+TEST_CASE("Test lexer", "[Test lexer]")
+{
+    const auto lexer = makeTestLexer();
+
+    const std::vector<Token> expected = {
+            {Keyword, 0, 2},
+            {Whitespace, 2, 3},
+            {Identifier, 3, 6},
+            {Operator, 6, 8},
+            {Number, 8, 10},
+            {Whitespace, 10, 11},
+            {Keyword, 11, 17},
+            {Whitespace, 17, 18},
+            {Identifier, 18, 25},
+    };
+    REQUIRE(lexer.tokenize("if iff==10 return return_") == expected);
+}
+
+TEST_CASE("Test lexer priority and maximal munch", "[Test lexer priority and maximal munch]")
+{
+    const auto lexer = makeTestLexer();
+
+    // 关键字与标识符匹配相同的长度时，优先级高的关键字胜出
+    REQUIRE(lexer.nextToken("while", 0) == Token{Keyword, 0, 5});
+    // 标识符匹配得更长时，最长匹配优先于优先级
+    REQUIRE(lexer.nextToken("whiles", 0) == Token{Identifier, 0, 6});
+    REQUIRE(lexer.nextToken("<=", 0) == Token{Operator, 0, 2});
+
+    // 优先级相同时先添加的规则胜出
+    LexerBuilder builder;
+    builder.add("[a-z]+", 1);
+    builder.add("abc", 2);
+    REQUIRE(builder.build().tokenize("abc") == std::vector<Token>{{1, 0, 3}});
+}
+
+TEST_CASE("Test lexer error token", "[Test lexer error token]")
+{
+    const auto lexer = makeTestLexer();
+
+    const std::vector<Token> expected = {
+            {Identifier, 0, 1},
+            {Lexer::ErrorToken, 1, 2},
+            {Lexer::ErrorToken, 2, 3},
+            {Number, 3, 4},
+    };
+    REQUIRE(lexer.tokenize("a$$1") == expected);
+    REQUIRE(lexer.tokenize("").empty());
+
+    // 只能匹配空输入的规则不产生记号
+    LexerBuilder builder;
+    builder.add("a*", 1);
+    REQUIRE(builder.build().tokenize("b") == std::vector<Token>{{Lexer::ErrorToken, 0, 1}});
+}
+
+TEST_CASE("Test lexer with accept sinks", "[Test lexer with accept sinks]")
+{
+    // 两条规则的接受汇点标记的记号不同，编译时不能合并
+    LexerBuilder builder;
+    builder.add("a.*", 1);
+    builder.add("b.*", 2);
+    const auto lexer = builder.build();
+    REQUIRE(lexer.tokenize("b") == std::vector<Token>{{2, 0, 1}});
+    REQUIRE(lexer.tokenize("bxyz") == std::vector<Token>{{2, 0, 4}});
+    REQUIRE(lexer.tokenize("axyz") == std::vector<Token>{{1, 0, 4}});
+    REQUIRE(lexer.tokenize("xa") == std::vector<Token>{{Lexer::ErrorToken, 0, 1}, {1, 1, 2}});
+}
+
+TEST_CASE("Test lexer without rescanning", "[Test lexer without rescanning]")
+{
+    // 每个记号都要扫描到输入末尾才能确定 a*b 不匹配，逐个调用nextToken是O(n^2)的
+    LexerBuilder builder;
+    builder.add("a", 1);
+    builder.add("a*b", 2);
+    const auto lexer = builder.build();
+
+    const std::string input(200000, 'a');
+    const auto tokens = lexer.tokenize(input);
+    REQUIRE(tokens.size() == input.size());
+    REQUIRE(tokens.back() == Token{1, input.size() - 1, input.size()});
+
+    std::mt19937 engine(5);
+    for (size_t test = 0; test < 300; test++)
+    {
+        std::string mixed(engine() % 30, 'a');
+        for (auto& c : mixed)
+        {
+            c = engine() % 8 == 0 ? 'b' : 'a';
+        }
+        std::vector<Token> expected;
+        for (size_t position = 0; position < mixed.size();)
+        {
+            expected.push_back(lexer.nextToken(mixed, position));
+            position = expected.back().end;
+        }
+        REQUIRE(lexer.tokenize(mixed) == expected);
+    }
+}
+
+// 逐条规则、逐个长度尝试的朴素实现，作为对照
+static Token naiveNextToken(const std::vector<LexerRule>& rules, const std::vector<CompiledDFA>& dfas, std::string_view inputs, size_t position)
+{
+    Token token{Lexer::ErrorToken, position, position + 1};
+    int priority = 0;
+    for (auto end = inputs.size(); end > position && token.tokenId == Lexer::ErrorToken; end--)
+    {
+        for (size_t rule = 0; rule < rules.size(); rule++)
+        {
+            if (dfas[rule].accept(inputs.substr(position, end - position)) &&
+                (token.tokenId == Lexer::ErrorToken || rules[rule].priority > priority))
+            {
+                token = {rules[rule].tokenId, position, end};
+                priority = rules[rule].priority;
+            }
+        }
+    }
+    return token;
+}
+
+TEST_CASE("Test lexer agrees with per-rule matching", "[Test lexer agrees with per-rule matching]")
+{
+    const std::vector<LexerRule> rules = {
+            {"ab", 1, 0},
+            {"a+b?", 2, 0},
+            {"(ab)+", 3, 1},
+            {"b[a-c]*", 4, 0},
+            {"c", 5, 2},
+            {"ca", 6, 0},
+    };
+    const Lexer lexer(rules);
+    std::vector<CompiledDFA> dfas;
+    for (const auto& rule : rules)
+    {
+        dfas.emplace_back(nfa2dfa::convertNFA2DFA(regex_generate::compile(rule.pattern)));
+    }
+
+    std::mt19937 engine(11);
+    for (size_t test = 0; test < 300; test++)
+    {
+        std::string input(engine() % 20, '\0');
+        for (auto& c : input)
+        {
+            c = "abcd"[engine() % 4];
+        }
+
+        std::vector<Token> expected;
+        for (size_t position = 0; position < input.size();)
+        {
+            expected.push_back(naiveNextToken(rules, dfas, input, position));
+            position = expected.back().end;
+        }
+        REQUIRE(lexer.tokenize(input) == expected);
+    }
+}
+
+TEST_CASE("Benchmark lexer", "[.][benchmark]")
+{
+    // 50个关键字加上标识符、数字、空白，共53条规则
+    LexerBuilder builder;
+    std::vector<std::string> keywords;
+    for (int i = 0; i < 50; i++)
+    {
+        keywords.push_back("kw" + std::to_string(i));
+        builder.add(keywords.back(), 100 + i, 1);
+    }
+    builder.add("[a-z_][a-z0-9_]*", Identifier);
+    builder.add("[0-9]+", Number);
+    builder.add(" +", Whitespace);
+    const auto lexer = builder.build();
+
+    std::mt19937 engine(3);
+    std::string input;
+    while (input.size() < 4 * 1024 * 1024)
+    {
+        switch (engine() % 3)
+        {
+        case 0:
+            input += keywords[engine() % keywords.size()];
+            break;
+        case 1:
+            input += "name" + std::to_string(engine() % 1000);
+            break;
+        default:
+            input += std::to_string(engine());
+            break;
+        }
+        input += ' ';
+    }
+
+    BENCHMARK("Lexer::tokenize 4MB with 53 rules")
+    {
+        return lexer.tokenize(input).size();
+    };
+}
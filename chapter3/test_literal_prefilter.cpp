@@ -0,0 +1,62 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <random>
+
+#include "catch2/catch_test_macros.hpp"
+#include "dfa_search.hpp"
+#include "literal_prefilter.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+
+static std::string getPrefix(std::string_view pattern)
+{
+    return extractLiteralPrefix(nfa2dfa::convertNFA2DFA(regex_generate::compile(pattern)).minimize());
+}
+
+TEST_CASE("Test extract literal prefix", "[Test extract literal prefix]")
+{
+    REQUIRE(getPrefix("abc(d|e)*") == "abc");
+    REQUIRE(getPrefix("ab|ac") == "a");
+    REQUIRE(getPrefix("(abc)+x") == "abc");
+    REQUIRE(getPrefix("ERROR code=[0-9]+") == "ERROR code=");
+    REQUIRE(getPrefix("abc") == "abc");
+    REQUIRE(getPrefix("a*b").empty());
+    REQUIRE(getPrefix("[ab]c").empty());
+    REQUIRE(getPrefix("").empty());
+}
+
+TEST_CASE("Test literal prefilter", "[Test literal prefilter]")
+{
+    std::mt19937 engine(5);
+    for (const std::string literal : {"a", "ab", "abc", "abca", "aaaaaaaaaaaaaaaaab"})
+    {
+        const LiteralPrefilter prefilter(literal);
+        for (size_t test = 0; test < 300; test++)
+        {
+            // 较小的字母表使字面量频繁出现，长度跨越多个16字节的块
+            std::string input(engine() % 80, '\0');
+            for (auto& c : input)
+            {
+                c = "abc"[engine() % 3];
+            }
+            const auto from = input.empty() ? 0 : engine() % (input.size() + 1);
+            REQUIRE(prefilter.find(input, from) == std::string_view(input).find(literal, from));
+        }
+    }
+
+    const LiteralPrefilter prefilter("xyz");
+    REQUIRE(prefilter.find("xy") == std::string_view::npos);
+    REQUIRE(prefilter.find("xyz", 4) == std::string_view::npos);
+    REQUIRE(LiteralPrefilter().find("abc", 1) == 1);
+}
+
+TEST_CASE("Test DFA search with prefilter", "[Test DFA search with prefilter]")
+{
+    const DFASearcher searcher(regex_generate::compile("ab(c|d)+"));
+    REQUIRE(searcher.getLiteralPrefix() == "ab");
+
+    REQUIRE(searcher.find("xxabxabcdcx") == MatchSpan{5, 10});
+    REQUIRE(searcher.find("abab") == std::nullopt);
+
+    const std::vector<MatchSpan> expected = {{0, 3}, {3, 6}, {8, 13}};
+    REQUIRE(searcher.findAll("abcabdababcddx") == expected);
+}
@@ -28,3 +28,29 @@ TEST_CASE("Test NFA", "[Test NFA]")
         REQUIRE(expectedAccepted == isAccepted);
     }
 }
+
+TEST_CASE("Test NFA state interning", "[Test NFA state interning]")
+{
+    std::vector<NFARule> const rules = {
+            {"q0", 'a', "q1"},
+            {"q1", 'b', "q2"},
+            {"q2", std::nullopt, "q0"},
+    };
+    NFAAcceptStates const acceptState({"q2"});
+
+    NFA const nfa("q0", rules, acceptState);
+
+    // 状态名称被驻留为稠密的编号，名称仅作为展示使用
+    REQUIRE(nfa.getStateCount() == 3);
+    REQUIRE(nfa.getStateName(nfa.getInitialState()) == "q0");
+    REQUIRE(nfa.getAcceptStateList().size() == 1);
+    REQUIRE(nfa.getStateName(nfa.getAcceptStateList().front()) == "q2");
+    REQUIRE(nfa.getEClosure(nfa.getAcceptStateList().front()).size() == 2);
+
+    // 直接使用编号构造的NFA没有名称表，使用编号作为展示名称
+    NFA const numbered(0, 2, {{0, 'a', 1}}, {1});
+    REQUIRE(numbered.getStateNames().empty());
+    REQUIRE(numbered.getStateName(1) == "1");
+    REQUIRE(numbered.accept(convertStringToInputs("a")));
+    REQUIRE(!numbered.accept(convertStringToInputs("aa")));
+}
@@ -1,10 +1,71 @@
 ﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <memory_resource>
+#include <thread>
+
 #include "catch2/catch_test_macros.hpp"
 #include "dfa2graphviz.hpp"
 #include "fa_common.hpp"
 #include "nfa.hpp"
 #include "nfa2dfa.hpp"
 #include "nfa2graphviz.hpp"
+#include "nfa_simulation.hpp"
+#include "regex_generate.hpp"
+
+namespace {
+
+// 统计分配次数的内存资源
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t getAllocationCount() const
+    {
+        return _allocationCount;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        _allocationCount++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    size_t _allocationCount = 0;
+};
+
+bool isSameDFA(const DFA& left, const DFA& right)
+{
+    if (left.getInitialState() != right.getInitialState() || left.getStateCount() != right.getStateCount() ||
+        left.getAcceptStateList() != right.getAcceptStateList() ||
+        left.getByteClasses().getClassMap() != right.getByteClasses().getClassMap())
+    {
+        return false;
+    }
+    for (StateId state = 0; state < left.getStateCount(); state++)
+    {
+        for (size_t input = 0; input < left.getByteClasses().getClassCount(); input++)
+        {
+            if (left.getNextStateByClass(state, static_cast<ByteClassId>(input)) !=
+                right.getNextStateByClass(state, static_cast<ByteClassId>(input)))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}// namespace
 
 TEST_CASE("Test NFA2DFA", "[Test NFA2DFA]")
 {
@@ -37,3 +98,94 @@ TEST_CASE("Test NFA2DFA", "[Test NFA2DFA]")
         REQUIRE(expectedAccepted == isAccepted);
     }
 }
+
+TEST_CASE("Test NFA2DFA with memory resource", "[Test NFA2DFA with memory resource]")
+{
+    const auto nfa = regex_generate::compile("(a|b)*a(a|b)(a|b)|[a-z]+@[a-z]+(\\.[a-z]+)+");
+    std::vector<std::vector<StateId>> expectedCombinationStates;
+    const auto expected = nfa2dfa::convertNFA2DFA(nfa, expectedCombinationStates);
+
+    // 临时结构都从传入的内存资源分配，结果与使用内部内存池时相同
+    CountingResource counting;
+    std::vector<std::vector<StateId>> combinationStates;
+    const auto dfa = nfa2dfa::convertNFA2DFA(nfa, combinationStates, &counting);
+    REQUIRE(counting.getAllocationCount() > 0);
+    REQUIRE(isSameDFA(dfa, expected));
+    REQUIRE(combinationStates == expectedCombinationStates);
+
+    // 每个线程使用自己的单调内存池
+    std::vector<DFA> results(4, expected);
+    std::vector<std::thread> threads;
+    for (auto& result : results)
+    {
+        threads.emplace_back([&nfa, &result] {
+            std::pmr::monotonic_buffer_resource arena;
+            result = nfa2dfa::convertNFA2DFA(nfa, &arena);
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (const auto& result : results)
+    {
+        REQUIRE(isSameDFA(result, expected));
+    }
+}
+
+TEST_CASE("Test NFA2DFA limits", "[Test NFA2DFA limits]")
+{
+    // 第n个字符之前是a的语言，DFA需要2^(n+1)个状态
+    constexpr std::string_view pattern = "x*(a|b)*a(a|b){16}";
+    std::vector<regex_generate::PatternSpan> stateSpans;
+    const auto nfa = regex_generate::compile(pattern, stateSpans);
+
+    nfa2dfa::DeterminizationLimits limits;
+    limits.maxStates = 1000;
+    bool limitHit = false;
+    try
+    {
+        nfa2dfa::convertNFA2DFA(nfa, limits);
+    }
+    catch (const nfa2dfa::DeterminizationLimitError& error)
+    {
+        limitHit = true;
+        REQUIRE(error.getStateCount() == limits.maxStates + 1);
+        REQUIRE(error.getMemoryBytes() > 0);
+        REQUIRE(!error.getHotStates().empty());
+        REQUIRE(std::string(error.what()).find("determinization exceeded the limit") != std::string::npos);
+
+        // 导致状态爆炸的NFA状态来自 (a|b)*a(a|b){16}（大部分来自计数的重复），而不是前面的 x*
+        const auto loop = pattern.find("(a|b)*");
+        const auto counted = pattern.find("(a|b){16}");
+        size_t countedStates = 0;
+        for (const auto& [state, subsetCount] : error.getHotStates())
+        {
+            REQUIRE(subsetCount < error.getStateCount());
+            REQUIRE(stateSpans[state].begin >= loop);
+            countedStates += stateSpans[state].begin >= counted;
+        }
+        REQUIRE(countedStates * 2 >= error.getHotStates().size());
+    }
+    REQUIRE(limitHit);
+
+    // 内存上限
+    limits = {};
+    limits.maxMemoryBytes = 64 * 1024;
+    REQUIRE_THROWS_AS(nfa2dfa::convertNFA2DFA(nfa, limits), nfa2dfa::DeterminizationLimitError);
+
+    // 超出上限时改用NFA模拟
+    const NFASimulator simulator(nfa);
+    const std::string accepted = "xxba" + std::string(16, 'b');
+    REQUIRE(simulator.accept(accepted));
+    REQUIRE(!simulator.accept("xxbb" + std::string(16, 'b')));
+
+    // 上限足够时结果与没有上限时相同
+    const auto smallNFA = regex_generate::compile("(a|b)*a(a|b){3}");
+    const auto smallDFA = nfa2dfa::convertNFA2DFA(smallNFA);
+    limits = {};
+    limits.maxStates = smallDFA.getStateCount();
+    REQUIRE(isSameDFA(nfa2dfa::convertNFA2DFA(smallNFA, limits), smallDFA));
+    limits.maxStates = smallDFA.getStateCount() - 1;
+    REQUIRE_THROWS_AS(nfa2dfa::convertNFA2DFA(smallNFA, limits), nfa2dfa::DeterminizationLimitError);
+}
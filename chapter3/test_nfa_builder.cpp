@@ -0,0 +1,160 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <algorithm>
+#include <random>
+#include <tuple>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nfa_builder.hpp"
+#include "regex_generate.hpp"
+
+namespace {
+
+using TransitionKey = std::tuple<StateId, StateId, bool, std::vector<std::pair<unsigned char, unsigned char>>>;
+
+std::vector<TransitionKey> getSortedTransitions(const NFA& nfa)
+{
+    std::vector<TransitionKey> result;
+    for (const auto& transition : nfa.getTransitions())
+    {
+        result.emplace_back(transition.startState,
+                            transition.nextState,
+                            transition.input.has_value(),
+                            transition.input ? transition.input->getRanges() : std::vector<std::pair<unsigned char, unsigned char>>{});
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// 构造器生成的NFA应与nfa_operator逐步组合的结果完全相同
+void requireSameNFA(const NFA& left, const NFA& right)
+{
+    REQUIRE(left.getInitialState() == right.getInitialState());
+    REQUIRE(left.getStateCount() == right.getStateCount());
+    REQUIRE(left.getAcceptStateList() == right.getAcceptStateList());
+    REQUIRE(getSortedTransitions(left) == getSortedTransitions(right));
+}
+
+}// namespace
+
+TEST_CASE("Test NFA builder", "[Test NFA builder]")
+{
+    NFABuilder builder;
+    const auto a = builder.add(regex_generate::Symbol('a'));
+    const auto b = builder.add(regex_generate::Range('b', 'd'));
+    // (a|[b-d])*a，片段a被引用了两次
+    const auto fragment = builder.concatenate(builder.repeat(builder.alternation(a, b)), a);
+    const auto nfa = builder.build(fragment);
+
+    const auto expected = nfa_operator::concatenate(
+            nfa_operator::repeat(nfa_operator::alternation(regex_generate::Symbol('a'), regex_generate::Range('b', 'd'))),
+            regex_generate::Symbol('a'));
+    requireSameNFA(nfa, expected);
+    REQUIRE(builder.getStateCount(fragment) == expected.getStateCount());
+
+    const std::vector<std::pair<std::string, bool>> tests = {
+            {"a", true},
+            {"bca", true},
+            {"aaa", true},
+            {"", false},
+            {"ab", false},
+            {"ea", false},
+    };
+    for (const auto& [input, expectedAccepted] : tests)
+    {
+        REQUIRE(nfa.accept(convertStringToInputs(input)) == expectedAccepted);
+    }
+}
+
+TEST_CASE("Test NFA builder against nfa operator", "[Test NFA builder against nfa operator]")
+{
+    std::mt19937 engine(22);
+    for (size_t round = 0; round < 200; round++)
+    {
+        NFABuilder builder;
+        std::vector<NFABuilder::Fragment> fragments;
+        std::vector<NFA> expected;
+        for (size_t i = 0; i < 30; i++)
+        {
+            const auto operation = fragments.empty() ? 0 : engine() % 4;
+            if (operation == 0)
+            {
+                const auto c = static_cast<char>('a' + engine() % 3);
+                fragments.push_back(builder.add(regex_generate::Symbol(c)));
+                expected.push_back(regex_generate::Symbol(c));
+                continue;
+            }
+            // 随机选取已有的片段作为操作数，同一个片段可能被多次引用
+            const auto left = engine() % fragments.size();
+            const auto right = engine() % fragments.size();
+            if (operation == 1)
+            {
+                fragments.push_back(builder.concatenate(fragments[left], fragments[right]));
+                expected.push_back(nfa_operator::concatenate(expected[left], expected[right]));
+            }
+            else if (operation == 2)
+            {
+                fragments.push_back(builder.alternation(fragments[left], fragments[right]));
+                expected.push_back(nfa_operator::alternation(expected[left], expected[right]));
+            }
+            else
+            {
+                fragments.push_back(builder.repeat(fragments[left]));
+                expected.push_back(nfa_operator::repeat(expected[left]));
+            }
+            if (expected.back().getStateCount() > 2000)
+            {
+                fragments.pop_back();
+                expected.pop_back();
+            }
+        }
+
+        for (size_t i = 0; i < fragments.size(); i++)
+        {
+            requireSameNFA(builder.build(fragments[i]), expected[i]);
+        }
+    }
+}
+
+TEST_CASE("Test NFA builder with deep nesting", "[Test NFA builder with deep nesting]")
+{
+    // 十万层嵌套的连接不会因递归而栈溢出
+    constexpr size_t Depth = 100000;
+    NFABuilder builder;
+    const auto a = builder.add(regex_generate::Symbol('a'));
+    auto fragment = a;
+    for (size_t i = 1; i < Depth; i++)
+    {
+        fragment = builder.concatenate(a, fragment);
+    }
+    const auto nfa = builder.build(fragment);
+    REQUIRE(nfa.getStateCount() == Depth * 2);
+    REQUIRE(nfa.accept(convertStringToInputs(std::string(Depth, 'a'))));
+    REQUIRE_FALSE(nfa.accept(convertStringToInputs(std::string(Depth - 1, 'a'))));
+}
+
+TEST_CASE("Benchmark NFA builder", "[.][benchmark]")
+{
+    constexpr size_t Count = 2000;
+    BENCHMARK("nfa_operator")
+    {
+        auto nfa = regex_generate::Symbol('a');
+        for (size_t i = 1; i < Count; i++)
+        {
+            nfa = nfa_operator::alternation(nfa_operator::concatenate(nfa, regex_generate::Symbol('b')), regex_generate::Symbol('c'));
+        }
+        return nfa.getStateCount();
+    };
+    BENCHMARK("NFABuilder")
+    {
+        NFABuilder builder;
+        auto fragment = builder.add(regex_generate::Symbol('a'));
+        const auto b = builder.add(regex_generate::Symbol('b'));
+        const auto c = builder.add(regex_generate::Symbol('c'));
+        for (size_t i = 1; i < Count; i++)
+        {
+            fragment = builder.alternation(builder.concatenate(fragment, b), c);
+        }
+        return builder.build(fragment).getStateCount();
+    };
+}
@@ -0,0 +1,30 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include "catch2/catch_test_macros.hpp"
+#include "nfa_reverse.hpp"
+#include "regex_generate.hpp"
+
+TEST_CASE("Test NFA reverse", "[Test NFA reverse]")
+{
+    const auto nfa = nfa_operator::reverse(regex_generate::compile("ab(c|de)*"));
+
+    const std::vector<std::pair<std::string, bool>> tests = {
+            {"ba", true},
+            {"cba", true},
+            {"edcba", true},
+            {"edcedcba", true},
+            {"deba", false},
+            {"ab", false},
+            {"dcba", false},
+            {"", false},
+    };
+
+    for (const auto& [input, expectedAccepted] : tests)
+    {
+        REQUIRE(expectedAccepted == nfa.accept(convertStringToInputs(input)));
+    }
+
+    // 两次反转得到原语言
+    const auto twice = nfa_operator::reverse(nfa);
+    REQUIRE(twice.accept(convertStringToInputs("abcde")));
+    REQUIRE(!twice.accept(convertStringToInputs("edcba")));
+}
@@ -0,0 +1,134 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <random>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nfa_simulation.hpp"
+#include "regex_generate.hpp"
+
+TEST_CASE("Test NFA simulation", "[Test NFA simulation]")
+{
+    // (abc|abcd)*
+    const auto nfa = nfa_operator::repeat(nfa_operator::alternation(regex_generate::Str("abc"), regex_generate::Str("abcd")));
+
+    const NFASimulator bitsetSimulator(nfa);
+    // 把位集合的状态上限设置为0，强制使用稀疏状态集合
+    const NFASimulator sparseSimulator(nfa, 0);
+    REQUIRE(bitsetSimulator.isBitParallel());
+    REQUIRE(!sparseSimulator.isBitParallel());
+
+    const std::vector<std::pair<std::string, bool>> tests = {
+            {"", true},
+            {"abc", true},
+            {"abcabcd", true},
+            {"abcdabcabcabcd", true},
+            {"ab", false},
+            {"abcab", false},
+            {"abcdd", false},
+    };
+
+    for (const auto& [input, expectedAccepted] : tests)
+    {
+        REQUIRE(expectedAccepted == nfa.accept(convertStringToInputs(input)));
+        REQUIRE(expectedAccepted == bitsetSimulator.accept(input));
+        REQUIRE(expectedAccepted == sparseSimulator.accept(input));
+    }
+
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<int> distribution(0, 3);
+    for (int i = 0; i < 300; i++)
+    {
+        std::string input(i % 17, '\0');
+        for (auto& c : input)
+        {
+            c = "abcd"[distribution(engine)];
+        }
+        const auto expectedAccepted = nfa.accept(convertStringToInputs(input));
+        REQUIRE(expectedAccepted == bitsetSimulator.accept(input));
+        REQUIRE(expectedAccepted == sparseSimulator.accept(input));
+    }
+}
+
+TEST_CASE("Test NFA simulation on long input", "[Test NFA simulation on long input]")
+{
+    // (a|b)*a(a|b)(a|b)，即倒数第三个字符为a
+    const auto ab = nfa_operator::alternation(regex_generate::Symbol('a'), regex_generate::Symbol('b'));
+    const auto nfa = nfa_operator::concatenate(nfa_operator::concatenate(nfa_operator::repeat(ab), regex_generate::Symbol('a')),
+                                               nfa_operator::concatenate(ab, ab));
+    const NFASimulator simulator(nfa);
+
+    std::string input(1024 * 1024, 'b');
+    REQUIRE(!simulator.accept(input));
+    REQUIRE(!nfa.accept(convertStringToInputs(input)));
+
+    input[input.size() - 3] = 'a';
+    REQUIRE(simulator.accept(input));
+    REQUIRE(nfa.accept(convertStringToInputs(input)));
+}
+
+TEST_CASE("Test NFA stream matcher", "[Test NFA stream matcher]")
+{
+    const auto nfa = regex_generate::compile("(ab|abc)*c[0-9]+");
+    std::mt19937 engine(17);
+    const std::string_view alphabet = "abc01";
+
+    // 位集合与稀疏集合两种模式
+    for (const auto bitsetStateLimit : {NFASimulator::DefaultBitsetStateLimit, size_t(0)})
+    {
+        const NFASimulator simulator(nfa, bitsetStateLimit);
+        NFASimulator::StreamMatcher matcher(simulator);
+
+        for (size_t test = 0; test < 500; test++)
+        {
+            std::string input(engine() % 16, '\0');
+            for (auto& c : input)
+            {
+                c = alphabet[engine() % alphabet.size()];
+            }
+            if (test % 2 == 0 && input.size() > 2)
+            {
+                // 构造一部分会被接受的输入
+                input = "ababc" + input.substr(0, 2) + "c01";
+            }
+
+            // 随机切分为若干块依次提供
+            matcher.reset();
+            size_t position = 0;
+            while (position < input.size())
+            {
+                const auto chunkSize = std::min<size_t>(engine() % 4, input.size() - position);
+                matcher.feed(std::span<const char>(input.data() + position, chunkSize));
+                position += chunkSize;
+            }
+            REQUIRE(matcher.finish() == simulator.accept(input));
+            REQUIRE(matcher.finish() == nfa.accept(convertStringToInputs(input)));
+        }
+    }
+}
+
+TEST_CASE("Test NFA stream matcher on long stream", "[Test NFA stream matcher on long stream]")
+{
+    // (a|b)*a(a|b)(a|b)，即倒数第三个字符为a
+    const auto nfa = regex_generate::compile("(a|b)*a(a|b)(a|b)");
+    const NFASimulator simulator(nfa);
+    NFASimulator::StreamMatcher matcher(simulator);
+
+    // 反复提供同一块数据，总长度为64MB，匹配的内存不随数据流长度增长
+    const std::string chunk(64 * 1024, 'b');
+    for (size_t i = 0; i < 1024; i++)
+    {
+        matcher.feed(chunk);
+    }
+    REQUIRE(!matcher.finish());
+
+    matcher.feed(std::string_view("abb"));
+    REQUIRE(matcher.finish());
+    REQUIRE(!matcher.isDead());
+
+    matcher.feed(std::string_view("c"));
+    REQUIRE(matcher.isDead());
+    REQUIRE(!matcher.finish());
+
+    matcher.reset();
+    matcher.feed(std::string_view("aab"));
+    REQUIRE(matcher.finish());
+}
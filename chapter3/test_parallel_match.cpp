@@ -0,0 +1,124 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <random>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nfa2dfa.hpp"
+#include "parallel_match.hpp"
+#include "regex_generate.hpp"
+
+static CompiledDFA compile(std::string_view pattern)
+{
+    return CompiledDFA(nfa2dfa::convertNFA2DFA(regex_generate::compile(pattern)).minimize());
+}
+
+static std::string makeRandomInput(size_t size, std::string_view alphabet, unsigned seed)
+{
+    std::mt19937 engine(seed);
+    std::string input(size, '\0');
+    for (auto& c : input)
+    {
+        c = alphabet[engine() % alphabet.size()];
+    }
+    return input;
+}
+
+// 顺序执行，统计被接受的非空前缀个数
+static size_t countSequential(const CompiledDFA& dfa, std::string_view inputs)
+{
+    size_t count = 0;
+    auto state = dfa.getInitialState();
+    for (const auto input : inputs)
+    {
+        state = dfa.getNextState(state, input);
+        count += dfa.isAcceptState(state);
+    }
+    return count;
+}
+
+TEST_CASE("Test parallel match", "[Test parallel match]")
+{
+    // 非锚定的模式：ab*c或者以ba结尾
+    const auto dfa = compile("[a-d]*(ab*c|ba)");
+
+    for (unsigned seed = 0; seed < 20; seed++)
+    {
+        auto input = makeRandomInput(10000 + seed * 997, "abcd", seed);
+        if (seed % 2 == 0)
+        {
+            input += "ba";
+        }
+        for (size_t threadCount : {1, 2, 3, 8})
+        {
+            for (size_t minChunkSize : {100, 1000, 100000})
+            {
+                REQUIRE(parallel_match::accept(dfa, input, threadCount, minChunkSize) == dfa.accept(input));
+                REQUIRE(parallel_match::countAcceptedPrefixes(dfa, input, threadCount, minChunkSize) == countSequential(dfa, input));
+            }
+        }
+    }
+
+    REQUIRE(!parallel_match::accept(dfa, ""));
+    REQUIRE(parallel_match::countAcceptedPrefixes(dfa, "") == 0);
+}
+
+TEST_CASE("Test parallel match uneven chunks", "[Test parallel match uneven chunks]")
+{
+    // 输入长度不是块数的倍数、块很小时，各块不能越过输入末尾
+    const auto dfa = compile("[a-d]*(ab*c|ba)");
+    REQUIRE(parallel_match::accept(compile("a*"), "aaaaa", 4, 1));
+
+    for (size_t size = 1; size < 40; size++)
+    {
+        const auto input = makeRandomInput(size, "abcd", static_cast<unsigned>(size));
+        for (size_t threadCount : {2, 3, 4, 7, 8, 16})
+        {
+            for (size_t minChunkSize : {1, 2, 3})
+            {
+                REQUIRE(parallel_match::accept(dfa, input, threadCount, minChunkSize) == dfa.accept(input));
+                REQUIRE(parallel_match::countAcceptedPrefixes(dfa, input, threadCount, minChunkSize) == countSequential(dfa, input));
+            }
+        }
+    }
+}
+
+TEST_CASE("Test parallel match without convergence", "[Test parallel match without convergence]")
+{
+    // 长度为100的倍数：DFA在100个状态之间循环，从不同状态出发的路径永远不会汇合，因此会放弃推测执行，退化为顺序执行
+    // 字符'x'会使所有路径进入死状态
+    const auto dfa = compile("([ab]{100})*");
+    REQUIRE(dfa.getStateCount() > parallel_match::MaxSpeculativeStates);
+
+    for (unsigned seed = 0; seed < 5; seed++)
+    {
+        const auto input = makeRandomInput(5000, "ab", seed);
+        REQUIRE(parallel_match::accept(dfa, input, 4, 100) == dfa.accept(input));
+        REQUIRE(parallel_match::countAcceptedPrefixes(dfa, input, 4, 100) == countSequential(dfa, input));
+
+        auto withDeadState = input;
+        withDeadState[2500] = 'x';
+        REQUIRE(!parallel_match::accept(dfa, withDeadState, 4, 100));
+        REQUIRE(parallel_match::countAcceptedPrefixes(dfa, withDeadState, 4, 100) == countSequential(dfa, withDeadState));
+    }
+}
+
+TEST_CASE("Benchmark parallel match", "[.][benchmark]")
+{
+    const auto dfa = compile("[a-d]*(ab*c|ba)");
+    const auto input = makeRandomInput(64 * 1024 * 1024, "abcd", 1);
+
+    BENCHMARK("CompiledDFA::accept 64MB")
+    {
+        return dfa.accept(input);
+    };
+
+    BENCHMARK("parallel_match::accept 64MB")
+    {
+        return parallel_match::accept(dfa, input);
+    };
+
+    BENCHMARK("parallel_match::countAcceptedPrefixes 64MB")
+    {
+        return parallel_match::countAcceptedPrefixes(dfa, input);
+    };
+}
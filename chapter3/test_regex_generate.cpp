@@ -1,5 +1,7 @@
 ﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
 #include <iostream>
+#include <random>
+#include <regex>
 
 #include "catch2/catch_test_macros.hpp"
 #include "dfa2graphviz.hpp"
@@ -83,4 +85,96 @@ TEST_CASE("Test regex generage match repeat str", "[Test regex generage match re
         const auto isAccepted = dfa.accept(convertStringToInputs(input));
         REQUIRE(expectedAccepted == isAccepted);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test regex compile", "[Test regex compile]")
+{
+    const auto nfa = regex_generate::compile("(abc|abcd)*[a-z]+");
+    const auto dfa = nfa2dfa::convertNFA2DFA(nfa).minimize();
+
+    const std::vector<std::pair<std::string, bool>> tests = {
+            {"", false},
+            {"x", true},
+            {"abcx", true},
+            {"abcdabcz", true},
+            {"abc", true},
+            {"abcabcd", true},
+            {"abc1", false},
+            {"ABC", false},
+    };
+
+    for (const auto& [input, expectedAccepted] : tests)
+    {
+        REQUIRE(expectedAccepted == nfa.accept(convertStringToInputs(input)));
+        REQUIRE(expectedAccepted == dfa.accept(convertStringToInputs(input)));
+    }
+}
+
+TEST_CASE("Test regex compile state spans", "[Test regex compile state spans]")
+{
+    constexpr std::string_view pattern = "ab|c*";
+    std::vector<regex_generate::PatternSpan> stateSpans;
+    const auto nfa = regex_generate::compile(pattern, stateSpans);
+    REQUIRE(stateSpans.size() == nfa.getStateCount());
+
+    // 每个字节转移的两端都属于生成它的字节节点
+    for (const auto& transition : nfa.getTransitions())
+    {
+        if (transition.input)
+        {
+            const auto text = stateSpans[transition.startState].of(pattern);
+            REQUIRE(text.size() == 1);
+            REQUIRE(transition.input->contains(text.front()));
+            REQUIRE(stateSpans[transition.nextState].of(pattern) == text);
+        }
+    }
+    // 起始状态属于最外层的选择
+    REQUIRE(stateSpans[nfa.getInitialState()].of(pattern) == pattern);
+}
+
+TEST_CASE("Test regex compile against std::regex", "[Test regex compile against std::regex]")
+{
+    const std::vector<std::string> patterns = {
+            "a|b|",
+            "(a|b)*a(a|b){3}",
+            "a{2,4}b?",
+            "(ab|a)(c|bcd)(d*)",
+            "[^ab]c+",
+            "[a-c]{2,}|d",
+            "\\d+\\.\\d*",
+            ".a.",
+            "(a*)*b",
+            "x(y?z?){0,2}",
+    };
+
+    std::mt19937 engine(11);
+    std::uniform_int_distribution<int> charDistribution(0, 7);
+    for (const auto& pattern : patterns)
+    {
+        const auto nfa = regex_generate::compile(pattern);
+        const auto dfa = nfa2dfa::convertNFA2DFA(nfa).minimize();
+        const std::regex expected(pattern);
+
+        for (int i = 0; i < 300; i++)
+        {
+            std::string input(i % 9, '\0');
+            for (auto& c : input)
+            {
+                c = "abcdxy1."[charDistribution(engine)];
+            }
+            const auto expectedAccepted = std::regex_match(input, expected);
+            REQUIRE(expectedAccepted == nfa.accept(convertStringToInputs(input)));
+            REQUIRE(expectedAccepted == dfa.accept(convertStringToInputs(input)));
+        }
+    }
+}
+
+TEST_CASE("Test regex compile syntax error", "[Test regex compile syntax error]")
+{
+    REQUIRE_THROWS_AS(regex_generate::compile("(ab"), regex_parser::RegexSyntaxError);
+    REQUIRE_THROWS_AS(regex_generate::compile("ab)"), regex_parser::RegexSyntaxError);
+    REQUIRE_THROWS_AS(regex_generate::compile("*a"), regex_parser::RegexSyntaxError);
+    REQUIRE_THROWS_AS(regex_generate::compile("[z-a]"), regex_parser::RegexSyntaxError);
+    REQUIRE_THROWS_AS(regex_generate::compile("a{3,1}"), regex_parser::RegexSyntaxError);
+    REQUIRE_THROWS_AS(regex_generate::compile("[abc"), regex_parser::RegexSyntaxError);
+}
@@ -0,0 +1,89 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include "catch2/catch_test_macros.hpp"
+#include "regex_parser.hpp"
+
+using regex_parser::RegexNode;
+
+TEST_CASE("Test regex parser", "[Test regex parser]")
+{
+    const auto ast = regex_parser::parse("(abc|abcd)*[a-z]+");
+
+    const auto& root = ast.getRoot();
+    REQUIRE(root.type == RegexNode::Type::Concatenate);
+    REQUIRE(root.children.size() == 2);
+
+    const auto& star = ast.nodes[root.children[0]];
+    REQUIRE(star.type == RegexNode::Type::Repeat);
+    REQUIRE(star.min == 0);
+    REQUIRE(star.max == regex_parser::Unbounded);
+    REQUIRE(ast.nodes[star.children[0]].type == RegexNode::Type::Alternation);
+
+    const auto& plus = ast.nodes[root.children[1]];
+    REQUIRE(plus.type == RegexNode::Type::Repeat);
+    REQUIRE(plus.min == 1);
+    const auto& range = ast.nodes[plus.children[0]];
+    REQUIRE(range.type == RegexNode::Type::Bytes);
+    REQUIRE(range.bytes.count() == 26);
+    REQUIRE(range.bytes.test('a'));
+    REQUIRE(range.bytes.test('z'));
+
+    // 节点在正则表达式中的位置，重复运算包括括号与重复符号
+    REQUIRE(std::make_pair(root.begin, root.end) == std::make_pair(size_t(0), size_t(17)));
+    REQUIRE(std::make_pair(star.begin, star.end) == std::make_pair(size_t(0), size_t(11)));
+    REQUIRE(std::make_pair(ast.nodes[star.children[0]].begin, ast.nodes[star.children[0]].end) == std::make_pair(size_t(1), size_t(9)));
+    REQUIRE(std::make_pair(plus.begin, plus.end) == std::make_pair(size_t(11), size_t(17)));
+    REQUIRE(std::make_pair(range.begin, range.end) == std::make_pair(size_t(11), size_t(16)));
+}
+
+TEST_CASE("Test regex parser character class", "[Test regex parser character class]")
+{
+    REQUIRE(regex_parser::parse("[^a]").getRoot().bytes.count() == 255);
+    REQUIRE(regex_parser::parse("[]a]").getRoot().bytes.count() == 2);
+    REQUIRE(regex_parser::parse("[a-]").getRoot().bytes.test('-'));
+    REQUIRE(regex_parser::parse("[\\d_]").getRoot().bytes.count() == 11);
+    REQUIRE(regex_parser::parse("\\x41").getRoot().bytes.test('A'));
+    REQUIRE(regex_parser::parse(".").getRoot().bytes.all());
+
+    const auto repeat = regex_parser::parse("a{2,5}").getRoot();
+    REQUIRE(repeat.min == 2);
+    REQUIRE(repeat.max == 5);
+}
+
+TEST_CASE("Test regex parser syntax error", "[Test regex parser syntax error]")
+{
+    const std::vector<std::pair<std::string, size_t>> tests = {
+            {"(ab", 0},
+            {"ab)", 2},
+            {"a|*", 2},
+            {"a{2", 3},
+            {"a\\", 1},
+            {"[b-a]", 1},
+            {"a{1001}", 2},
+            // 每个重复都不超过上限，但是嵌套之后展开得过大
+            {"((a{1000}){1000}){1000}", 1},
+            {"xy(a{400}b{400}){200}", 2},
+            // 嵌套过深，递归解析会导致栈溢出
+            {"x" + std::string(200000, '(') + "a" + std::string(200000, ')'), 1001},
+            {"a" + std::string(200000, '?'), 0},
+    };
+
+    for (const auto& [pattern, position] : tests)
+    {
+        bool thrown = false;
+        try
+        {
+            regex_parser::parse(pattern);
+        }
+        catch (const regex_parser::RegexSyntaxError& error)
+        {
+            thrown = true;
+            REQUIRE(error.position() == position);
+        }
+        REQUIRE(thrown);
+    }
+
+    // 展开之后不超过上限的重复可以正常解析
+    REQUIRE(regex_parser::parse("(a{100}){100}").getRoot().max == 100);
+    // 不超过上限的嵌套可以正常解析
+    REQUIRE(regex_parser::parse(std::string(500, '(') + "a" + std::string(500, ')')).getRoot().type == regex_parser::RegexNodeType::Bytes);
+}
@@ -0,0 +1,88 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <map>
+#include <random>
+
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+#include "state_set_table.hpp"
+
+TEST_CASE("Test state set table", "[Test state set table]")
+{
+    StateSetTable table;
+    REQUIRE(table.intern(std::vector<StateId>{1, 12}) == std::make_pair(StateId(0), true));
+    // 名称拼接相同（"112"）的不同集合得到不同的编号
+    REQUIRE(table.intern(std::vector<StateId>{11, 2}) == std::make_pair(StateId(1), true));
+    REQUIRE(table.intern(std::vector<StateId>{}) == std::make_pair(StateId(2), true));
+    REQUIRE(table.intern(std::vector<StateId>{1, 12}) == std::make_pair(StateId(0), false));
+    REQUIRE(table.find(std::vector<StateId>{11, 2}) == 1);
+    REQUIRE(table.find(std::vector<StateId>{1}) == InvalidStateId);
+    REQUIRE(table.size() == 3);
+    REQUIRE(table.getElementCount() == 4);
+
+    const auto stateSet = table.getStateSet(1);
+    REQUIRE(std::vector<StateId>(stateSet.begin(), stateSet.end()) == std::vector<StateId>{11, 2});
+
+    table.clear();
+    REQUIRE(table.size() == 0);
+    REQUIRE(table.find(std::vector<StateId>{1, 12}) == InvalidStateId);
+}
+
+TEST_CASE("Test state set table against map", "[Test state set table against map]")
+{
+    std::mt19937 engine(21);
+    StateSetTable table;
+    std::map<std::vector<StateId>, StateId> expected;
+    for (size_t i = 0; i < 50000; i++)
+    {
+        // 小的状态编号范围使集合经常重复
+        std::vector<StateId> stateSet;
+        for (StateId state = 0; state < 12; state++)
+        {
+            if (engine() % 3 == 0)
+            {
+                stateSet.push_back(state);
+            }
+        }
+        const auto [it, inserted] = expected.try_emplace(stateSet, static_cast<StateId>(expected.size()));
+        REQUIRE(table.intern(stateSet) == std::make_pair(it->second, inserted));
+    }
+    REQUIRE(table.size() == expected.size());
+    for (const auto& [stateSet, id] : expected)
+    {
+        const auto stored = table.getStateSet(id);
+        REQUIRE(std::vector<StateId>(stored.begin(), stored.end()) == stateSet);
+        REQUIRE(table.find(stateSet) == id);
+    }
+}
+
+TEST_CASE("Benchmark subset construction", "[.][benchmark]")
+{
+    // 约1.2万个NFA状态的单词并集，以及DFA有3万多个状态的(a|b)*a(a|b){14}
+    std::mt19937 engine(1);
+    std::string words;
+    for (size_t i = 0; i < 800; i++)
+    {
+        if (i > 0)
+        {
+            words += '|';
+        }
+        for (size_t length = 4 + engine() % 8; length > 0; length--)
+        {
+            words += static_cast<char>('a' + engine() % 26);
+        }
+    }
+    const auto wordsNFA = regex_generate::compile(words);
+    const auto exponentialNFA = regex_generate::compile("(a|b)*a(a|b){14}");
+
+    BENCHMARK("convertNFA2DFA 800 words")
+    {
+        return nfa2dfa::convertNFA2DFA(wordsNFA).getStateCount();
+    };
+
+    BENCHMARK("convertNFA2DFA (a|b)*a(a|b){14}")
+    {
+        return nfa2dfa::convertNFA2DFA(exponentialNFA).getStateCount();
+    };
+}
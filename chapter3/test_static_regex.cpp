@@ -0,0 +1,53 @@
+﻿#define CATCH_CONFIG_MAIN// This tells Catch to provide a main() - only do this in one cpp file
+#include <random>
+
+#include "catch2/catch_test_macros.hpp"
+#include "compiled_dfa.hpp"
+#include "nfa2dfa.hpp"
+#include "regex_generate.hpp"
+#include "static_regex.hpp"
+
+using static_regex::StaticRegex;
+
+// 编译期匹配
+static_assert(StaticRegex<"a(b|c)*d">::accept("abcbd"));
+static_assert(StaticRegex<"a(b|c)*d">::accept("ad"));
+static_assert(!StaticRegex<"a(b|c)*d">::accept("abcb"));
+static_assert(StaticRegex<"[0-9]{2,3}">::accept("123"));
+static_assert(!StaticRegex<"[0-9]{2,3}">::accept("1234"));
+static_assert(StaticRegex<"">::accept(""));
+static_assert(!StaticRegex<"">::accept("a"));
+// 进入接受汇点或死状态之后不再处理剩余的输入
+static_assert(StaticRegex<"ab.*">::accept("abababababababababababababababababababababababababababababababababababababab"));
+static_assert(!StaticRegex<"ab.*">::accept("baababababababababababababababababababababababababababababababababababababab"));
+
+template<static_regex::FixedString Pattern>
+static void checkSameAsRuntime(std::mt19937& engine, std::string_view alphabet)
+{
+    const auto minimized = nfa2dfa::convertNFA2DFA(regex_generate::compile(Pattern.view())).minimize();
+    const CompiledDFA dfa(minimized);
+    // 最小化后的状态数相同（编译期的DFA包含死状态）
+    REQUIRE(StaticRegex<Pattern>::StateCount == dfa.getStateCount());
+
+    for (size_t test = 0; test < 1000; test++)
+    {
+        std::string input(engine() % 12, '\0');
+        for (auto& c : input)
+        {
+            c = alphabet[engine() % alphabet.size()];
+        }
+        REQUIRE(StaticRegex<Pattern>::accept(input) == dfa.accept(input));
+    }
+}
+
+TEST_CASE("Test static regex", "[Test static regex]")
+{
+    std::mt19937 engine(16);
+    checkSameAsRuntime<"a(b|c)*d">(engine, "abcde");
+    checkSameAsRuntime<"(a|b)*abb">(engine, "abc");
+    checkSameAsRuntime<"[a-c]+@[a-c]+(\\.[a-c]+)+">(engine, "abcd@.");
+    checkSameAsRuntime<"(ab){1,3}c?">(engine, "abc");
+    checkSameAsRuntime<"[^a]*a[^a]*">(engine, "ab");
+    checkSameAsRuntime<"(a|ab)(c|bcd)(d*)">(engine, "abcd");
+    checkSameAsRuntime<"a.*b|ba.*">(engine, "abc");
+}
@@ -0,0 +1,160 @@
+﻿#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "fa_common.hpp"
+#include "regex_parser.hpp"
+
+namespace regex_generate {
+
+// Thompson NFA片段：[起始状态、终止状态]
+struct ThompsonFragment
+{
+    StateId start;
+    StateId end;
+};
+
+// 根据语法树一次性生成Thompson NFA
+// 每个语法树节点生成一个[起始状态、终止状态]片段，状态编号按需分配，不需要复制或者重命名已生成的状态转移
+// ByteSetType为语法树的字节集合类型，生成的转移交给TransitionSink保存，它需要提供：
+//   addBytes(from, bytes, to)：以字节集合为输入的转移
+//   addEpsilon(from, to)：ε转移
+// 所有成员函数都是constexpr的，运行时（regex_generate::compile）与编译期（static_regex）共用同一份构造
+template<typename ByteSetType, typename TransitionSink>
+class BasicThompsonEmitter
+{
+public:
+    constexpr BasicThompsonEmitter(const regex_parser::BasicRegexAst<ByteSetType>& ast, TransitionSink& sink)
+        : _ast(ast),
+          _sink(sink)
+    {
+    }
+
+    constexpr ThompsonFragment emit()
+    {
+        return emitNode(_ast.root);
+    }
+
+    constexpr StateId getStateCount() const
+    {
+        return _stateCount;
+    }
+
+    // 每个NFA状态由哪个语法树节点生成，emit之后有效
+    constexpr const std::vector<size_t>& getStateNodes() const
+    {
+        return _stateNodes;
+    }
+
+private:
+    // 生成节点期间新建的状态都属于该节点，子节点生成完之后恢复为父节点
+    constexpr ThompsonFragment emitNode(size_t index)
+    {
+        const auto parent = std::exchange(_currentNode, index);
+        const auto fragment = emitNodeStates(index);
+        _currentNode = parent;
+        return fragment;
+    }
+
+    constexpr ThompsonFragment emitNodeStates(size_t index)
+    {
+        const auto& node = _ast.nodes[index];
+        switch (node.type)
+        {
+            case regex_parser::RegexNodeType::Empty:
+            {
+                const auto state = newState();
+                return {state, state};
+            }
+            case regex_parser::RegexNodeType::Bytes:
+            {
+                // 整个字节集合只需要一条转移
+                const auto start = newState();
+                const auto end = newState();
+                _sink.addBytes(start, node.bytes, end);
+                return {start, end};
+            }
+            case regex_parser::RegexNodeType::Concatenate:
+            {
+                auto fragment = emitNode(node.children.front());
+                for (size_t i = 1; i < node.children.size(); i++)
+                {
+                    const auto next = emitNode(node.children[i]);
+                    _sink.addEpsilon(fragment.end, next.start);
+                    fragment.end = next.end;
+                }
+                return fragment;
+            }
+            case regex_parser::RegexNodeType::Alternation:
+            {
+                const auto start = newState();
+                const auto end = newState();
+                for (const auto child : node.children)
+                {
+                    const auto fragment = emitNode(child);
+                    _sink.addEpsilon(start, fragment.start);
+                    _sink.addEpsilon(fragment.end, end);
+                }
+                return {start, end};
+            }
+            case regex_parser::RegexNodeType::Repeat:
+            default:
+                return emitRepeat(node.children.front(), node.min, node.max);
+        }
+    }
+
+    // 将 X{min,max} 展开为 min 个 X，再连接 X*（max无上限时）或者 max-min 个可选的 X
+    constexpr ThompsonFragment emitRepeat(size_t child, int min, int max)
+    {
+        const auto start = newState();
+        ThompsonFragment fragment{start, start};
+        for (int i = 0; i < min; i++)
+        {
+            const auto next = emitNode(child);
+            _sink.addEpsilon(fragment.end, next.start);
+            fragment.end = next.end;
+        }
+
+        if (max == regex_parser::Unbounded)
+        {
+            const auto loop = emitNode(child);
+            const auto end = newState();
+            _sink.addEpsilon(fragment.end, loop.start);
+            _sink.addEpsilon(fragment.end, end);
+            _sink.addEpsilon(loop.end, loop.start);
+            _sink.addEpsilon(loop.end, end);
+            fragment.end = end;
+        }
+        else if (max > min)
+        {
+            // 每个可选的 X 都可以直接跳到最终的终止状态
+            const auto end = newState();
+            for (int i = min; i < max; i++)
+            {
+                const auto optional = emitNode(child);
+                _sink.addEpsilon(fragment.end, optional.start);
+                _sink.addEpsilon(fragment.end, end);
+                fragment.end = optional.end;
+            }
+            _sink.addEpsilon(fragment.end, end);
+            fragment.end = end;
+        }
+        return fragment;
+    }
+
+    constexpr StateId newState()
+    {
+        _stateNodes.push_back(_currentNode);
+        return _stateCount++;
+    }
+
+private:
+    const regex_parser::BasicRegexAst<ByteSetType>& _ast;
+    TransitionSink& _sink;
+    StateId _stateCount = 0;
+    size_t _currentNode = 0;
+    std::vector<size_t> _stateNodes;
+};
+
+}// namespace regex_generate
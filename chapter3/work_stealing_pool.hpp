@@ -0,0 +1,192 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池
+// parallelFor把任务编号[0, taskCount)平均分给每个工作线程（调用者线程作为0号工作线程一起执行），
+// 每个工作线程从自己区间的前端依次取任务；自己的区间取完之后，从其他工作线程的区间后端窃取一半，
+// 因此任务的耗时不均匀时各线程的负载仍然是均衡的。
+// 每个区间用一个64位原子变量表示（高32位为开始、低32位为结束），取任务与窃取都只需要一次CAS，不需要加锁
+class WorkStealingPool
+{
+public:
+    // threadCount为工作线程总数（包括调用者线程），为0时使用硬件线程数
+    explicit WorkStealingPool(size_t threadCount = 0)
+        : _workerCount(threadCount == 0 ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : threadCount),
+          _ranges(std::make_unique<WorkRange[]>(_workerCount))
+    {
+        for (size_t worker = 1; worker < _workerCount; worker++)
+        {
+            _threads.emplace_back([this, worker]() {
+                workerLoop(worker);
+            });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _startCondition.notify_all();
+        for (auto& thread : _threads)
+        {
+            thread.join();
+        }
+    }
+
+    size_t getWorkerCount() const
+    {
+        return _workerCount;
+    }
+
+    // 以task(工作线程编号, 任务编号)的形式执行所有任务，全部完成之后才返回
+    // 同一时间只能有一个调用者执行parallelFor
+    void parallelFor(size_t taskCount, const std::function<void(size_t, size_t)>& task)
+    {
+        for (size_t worker = 0; worker < _workerCount; worker++)
+        {
+            const auto begin = taskCount * worker / _workerCount;
+            const auto end = taskCount * (worker + 1) / _workerCount;
+            _ranges[worker].range.store(pack(static_cast<uint32_t>(begin), static_cast<uint32_t>(end)), std::memory_order_relaxed);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task = &task;
+            _runningWorkers = _threads.size();
+            _generation++;
+        }
+        _startCondition.notify_all();
+
+        runTasks(0);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _doneCondition.wait(lock, [this]() {
+            return _runningWorkers == 0;
+        });
+        _task = nullptr;
+    }
+
+private:
+    // 独占一个缓存行，避免不同工作线程的区间之间的伪共享
+    struct alignas(64) WorkRange
+    {
+        std::atomic<uint64_t> range{0};
+    };
+
+    static uint64_t pack(uint32_t begin, uint32_t end)
+    {
+        return (static_cast<uint64_t>(begin) << 32) | end;
+    }
+
+    void workerLoop(size_t worker)
+    {
+        size_t generation = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _startCondition.wait(lock, [this, generation]() {
+                    return _stopping || _generation != generation;
+                });
+                if (_stopping)
+                {
+                    return;
+                }
+                generation = _generation;
+            }
+
+            runTasks(worker);
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _runningWorkers--;
+            }
+            _doneCondition.notify_one();
+        }
+    }
+
+    void runTasks(size_t worker)
+    {
+        uint32_t task = 0;
+        while (popTask(worker, task) || stealTask(worker, task))
+        {
+            (*_task)(worker, task);
+        }
+    }
+
+    // 从自己的区间前端取一个任务
+    bool popTask(size_t worker, uint32_t& task)
+    {
+        auto& range = _ranges[worker].range;
+        auto current = range.load(std::memory_order_acquire);
+        while (true)
+        {
+            const auto begin = static_cast<uint32_t>(current >> 32);
+            const auto end = static_cast<uint32_t>(current);
+            if (begin >= end)
+            {
+                return false;
+            }
+            if (range.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel))
+            {
+                task = begin;
+                return true;
+            }
+        }
+    }
+
+    // 从其他工作线程的区间后端窃取一半的任务，其中第一个任务立即执行，其余的作为自己新的区间
+    bool stealTask(size_t worker, uint32_t& task)
+    {
+        for (size_t i = 1; i < _workerCount; i++)
+        {
+            auto& victim = _ranges[(worker + i) % _workerCount].range;
+            auto current = victim.load(std::memory_order_acquire);
+            while (true)
+            {
+                const auto begin = static_cast<uint32_t>(current >> 32);
+                const auto end = static_cast<uint32_t>(current);
+                if (begin >= end)
+                {
+                    break;
+                }
+                const auto middle = begin + (end - begin) / 2;
+                if (victim.compare_exchange_weak(current, pack(begin, middle), std::memory_order_acq_rel))
+                {
+                    // 自己的区间此时为空，其他线程不会修改它
+                    task = middle;
+                    _ranges[worker].range.store(pack(middle + 1, end), std::memory_order_release);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    size_t _workerCount;
+    std::unique_ptr<WorkRange[]> _ranges;
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+    std::condition_variable _startCondition;
+    std::condition_variable _doneCondition;
+    size_t _generation = 0;
+    size_t _runningWorkers = 0;
+    bool _stopping = false;
+    const std::function<void(size_t, size_t)>* _task = nullptr;
+};